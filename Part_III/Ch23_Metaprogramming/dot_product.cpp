@@ -17,6 +17,10 @@ constexpr auto dot_product(std::array<T,N> const& x, std::array<T,N> const& y) n
 }
 
 // Using partial specialization, avoids the loop:
+// (only sensible for small, compile-time N - for runtime-sized data see dot() in
+// Ch27_ExpressionTemplates/expr_reduce.hpp, which also fuses expression templates into the sum;
+// fixed_kernels.hpp replaces the recursion by a fold over an index_sequence, for dot, axpy,
+// cross, norm and matvec)
 template<typename T, size_t N>
 struct DotProduct {
     static constexpr T result(const T* a, const T* b) {
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+// Small-vector kernels for a compile-time N - the idea of DotProduct<T,N> in dot_product.cpp,
+// generalized. Rather than recursing over N (one instantiation per element), every kernel
+// expands an index_sequence<0, ..., N-1> in a single fold expression, so a kernel is one
+// instantiation whatever N is, and the compiler sees N independent operations it can keep in
+// registers and combine into SIMD instructions. All of them but norm() are constexpr:
+//   constexpr std::array<double,3> x{1, 2, 3}, y{4, 5, 6};
+//   static_assert(dot(x, y) == 32.0);
+//   auto z = axpy(2.0, x, y);                       // 2x + y
+//   auto w = matvec(m, x);                          // std::array<std::array<T,N>,M> times x
+// They take std::arrays, or pointers to N elements: dot<4>(p, q).
+// Beyond fixed_kernel_limit elements the runtime loop is as fast and the code is smaller.
+
+constexpr inline std::size_t fixed_kernel_limit = 16;
+
+// number of partial sums of dot() - independent chains of additions, which fill the
+// lanes of a SIMD register (a single running sum would make every addition wait for the
+// previous one, as the compiler may not reorder floating point additions)
+constexpr inline std::size_t fixed_dot_lanes = 4;
+static_assert(fixed_dot_lanes > 0);
+
+
+// p[0] + ... + p[n-1], added pairwise: (p[0] + p[1]) + (p[2] + p[3]) for n = 4
+template<typename T>
+constexpr T pairwise_sum(T const* p, std::size_t n)
+{
+    return n == 1 ? p[0] : pairwise_sum(p, n / 2) + pairwise_sum(p + n / 2, n - n / 2);
+}
+
+// the folds, over I = 0, ..., N-1
+template<typename T, std::size_t... I>
+constexpr T dot_impl(T const* x, T const* y, std::index_sequence<I...>)
+{
+    T partial[fixed_dot_lanes]{};
+    ((partial[I % fixed_dot_lanes] += x[I] * y[I]), ...);
+    return pairwise_sum(partial, fixed_dot_lanes);
+}
+
+template<typename T, std::size_t... I>
+constexpr void axpy_impl(T a, T const* x, T* y, std::index_sequence<I...>)
+{
+    ((y[I] = a * x[I] + y[I]), ...);
+}
+
+template<typename T, std::size_t N, std::size_t... R>
+constexpr void matvec_impl(std::array<T,N> const* m, T const* x, T* y,
+                           std::index_sequence<R...>)
+{
+    ((y[R] = dot_impl(m[R].data(), x, std::make_index_sequence<N>{})), ...);
+}
+
+
+// x[0]*y[0] + ... + x[N-1]*y[N-1]
+template<std::size_t N, typename T>
+constexpr T dot(T const* x, T const* y)
+{
+    static_assert(N <= fixed_kernel_limit, "dot: use a runtime loop for large N");
+    return dot_impl(x, y, std::make_index_sequence<N>{});
+}
+
+template<typename T, std::size_t N>
+constexpr T dot(std::array<T,N> const& x, std::array<T,N> const& y)
+{
+    return dot<N>(x.data(), y.data());
+}
+
+// y = a*x + y
+template<std::size_t N, typename T>
+constexpr void axpy(T a, T const* x, T* y)
+{
+    static_assert(N <= fixed_kernel_limit, "axpy: use a runtime loop for large N");
+    axpy_impl(a, x, y, std::make_index_sequence<N>{});
+}
+
+template<typename T, std::size_t N>
+constexpr std::array<T,N> axpy(T a, std::array<T,N> const& x, std::array<T,N> y)
+{
+    axpy<N>(a, x.data(), y.data());
+    return y;
+}
+
+// x × y
+template<typename T>
+constexpr std::array<T,3> cross(std::array<T,3> const& x, std::array<T,3> const& y)
+{
+    return {x[1] * y[2] - x[2] * y[1],
+            x[2] * y[0] - x[0] * y[2],
+            x[0] * y[1] - x[1] * y[0]};
+}
+
+// squared Euclidean norm, dot(x, x)
+template<std::size_t N, typename T>
+constexpr T norm2(T const* x)
+{
+    return dot<N>(x, x);
+}
+
+template<typename T, std::size_t N>
+constexpr T norm2(std::array<T,N> const& x)
+{
+    return norm2<N>(x.data());
+}
+
+// Euclidean norm (not constexpr, as std::sqrt is not)
+template<std::size_t N, typename T>
+T norm(T const* x)
+{
+    return std::sqrt(norm2<N>(x));
+}
+
+template<typename T, std::size_t N>
+T norm(std::array<T,N> const& x)
+{
+    return norm<N>(x.data());
+}
+
+// m*x, for the M×N matrix m of rows m[0], ..., m[M-1]
+template<typename T, std::size_t M, std::size_t N>
+constexpr std::array<T,M> matvec(std::array<std::array<T,N>,M> const& m, std::array<T,N> const& x)
+{
+    static_assert(M <= fixed_kernel_limit && N <= fixed_kernel_limit,
+                  "matvec: use a runtime loop for large matrices");
+    std::array<T,M> y{};
+    matvec_impl(m.data(), x.data(), y.data(), std::make_index_sequence<M>{});
+    return y;
+}
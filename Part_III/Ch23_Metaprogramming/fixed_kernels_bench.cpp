@@ -0,0 +1,186 @@
+#include <iostream>
+#include <iomanip>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+#include "fixed_kernels.hpp"
+
+
+// The kernels of fixed_kernels.hpp against the same loops over a runtime n, for N = 3, 4, 8
+// and 16, applied to a stream of vectors (about 2^20 doubles) which stays in the cache:
+// - dot:    x·y of consecutive pairs
+// - axpy:   y = a*x + y
+// - norm:   |x|
+// - matvec: m*x, m N×N
+// (cross() exists only for N = 3, with no loop to compare it with)
+// Times are ns per call; build with -DCMAKE_BUILD_TYPE=Release.
+//
+// usage: fixed_kernels_bench [doubles]
+
+// (std::array's operator== is not constexpr before C++20)
+constexpr auto crossed = cross(std::array<int,3>{1, 0, 0}, std::array<int,3>{0, 1, 0});
+constexpr auto summed = axpy(2, std::array<int,4>{1, 2, 3, 4}, std::array<int,4>{1, 1, 1, 1});
+constexpr auto product = matvec(std::array<std::array<int,2>,3>{{{1, 0}, {0, 1}, {1, 1}}},
+                                std::array<int,2>{2, 5});
+static_assert(dot(std::array<int,3>{1, 2, 3}, std::array<int,3>{9, 8, 7}) == 46);
+static_assert(crossed[0] == 0 && crossed[1] == 0 && crossed[2] == 1);
+static_assert(summed[0] == 3 && summed[1] == 5 && summed[2] == 7 && summed[3] == 9);
+static_assert(norm2(std::array<int,2>{3, 4}) == 25);
+static_assert(product[0] == 2 && product[1] == 5 && product[2] == 7);
+
+
+// the generic runtime loops
+double dot_loop(double const* x, double const* y, std::size_t n)
+{
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+void axpy_loop(double a, double const* x, double* y, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        y[i] = a * x[i] + y[i];
+    }
+}
+
+void matvec_loop(double const* m, double const* x, double* y, std::size_t rows, std::size_t cols)
+{
+    for (std::size_t r = 0; r < rows; ++r) {
+        y[r] = dot_loop(m + r * cols, x, cols);
+    }
+}
+
+
+template<typename T>
+inline void do_not_optimize(T const& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// best of 5, in ns per call
+template<typename F>
+double time_per_call(std::size_t calls, F&& f)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < 5; ++r) {
+        auto const start = std::chrono::steady_clock::now();
+        f();
+        auto const stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    return best / static_cast<double>(calls);
+}
+
+// (read through a volatile, so that the loops really run over a runtime n)
+volatile std::size_t runtime_n;
+
+template<std::size_t N>
+void run(std::vector<double>& data)
+{
+    using Vec = std::array<double,N>;
+    runtime_n = N;
+    std::size_t const n = runtime_n;
+    std::size_t const count = data.size() / N;
+    double* const v = data.data();
+
+    auto const print = [](char const* kernel, double fixed, double loop) {
+        std::cout << std::setw(2) << N << "  " << std::left << std::setw(8) << kernel
+                  << std::right << std::setw(10) << fixed << std::setw(10) << loop << '\n';
+    };
+
+    double const dot_fixed = time_per_call(count - 1, [&]{
+        double sum = 0.0;
+        for (std::size_t i = 0; i + 1 < count; ++i) {
+            sum += dot<N>(v + i * N, v + (i + 1) * N);
+        }
+        do_not_optimize(sum);
+    });
+    double const dot_runtime = time_per_call(count - 1, [&]{
+        double sum = 0.0;
+        for (std::size_t i = 0; i + 1 < count; ++i) {
+            sum += dot_loop(v + i * N, v + (i + 1) * N, n);
+        }
+        do_not_optimize(sum);
+    });
+    print("dot", dot_fixed, dot_runtime);
+
+    // (x and y a few vectors apart, so that the elements written are not read again)
+    double const axpy_fixed = time_per_call(count - 4, [&]{
+        for (std::size_t i = 0; i + 4 < count; ++i) {
+            axpy<N>(1e-9, v + i * N, v + (i + 4) * N);
+        }
+        do_not_optimize(v[0]);
+    });
+    double const axpy_runtime = time_per_call(count - 4, [&]{
+        for (std::size_t i = 0; i + 4 < count; ++i) {
+            axpy_loop(1e-9, v + i * N, v + (i + 4) * N, n);
+        }
+        do_not_optimize(v[0]);
+    });
+    print("axpy", axpy_fixed, axpy_runtime);
+
+    double const norm_fixed = time_per_call(count, [&]{
+        double sum = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            sum += norm<N>(v + i * N);
+        }
+        do_not_optimize(sum);
+    });
+    double const norm_runtime = time_per_call(count, [&]{
+        double sum = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            sum += std::sqrt(dot_loop(v + i * N, v + i * N, n));
+        }
+        do_not_optimize(sum);
+    });
+    print("norm", norm_fixed, norm_runtime);
+
+    // (the loop takes the same matrix as one array of N*N elements, row by row)
+    std::array<Vec,N> m{};
+    std::array<double,N*N> flat{};
+    for (std::size_t r = 0; r < N; ++r) {
+        for (std::size_t c = 0; c < N; ++c) {
+            m[r][c] = flat[r * N + c] = 1.0 / static_cast<double>(r + c + 1);
+        }
+    }
+    double const matvec_fixed = time_per_call(count, [&]{
+        double sum = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            Vec x;
+            std::copy(v + i * N, v + (i + 1) * N, x.begin());
+            sum += matvec(m, x)[N - 1];
+        }
+        do_not_optimize(sum);
+    });
+    double const matvec_runtime = time_per_call(count, [&]{
+        double sum = 0.0;
+        Vec y;
+        for (std::size_t i = 0; i < count; ++i) {
+            matvec_loop(flat.data(), v + i * N, y.data(), n, n);
+            sum += y[N - 1];
+        }
+        do_not_optimize(sum);
+    });
+    print("matvec", matvec_fixed, matvec_runtime);
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t const doubles = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1u << 20;
+    std::vector<double> data(doubles);
+    for (std::size_t i = 0; i < doubles; ++i) {
+        data[i] = std::sin(static_cast<double>(i));
+    }
+
+    std::cout << " N  kernel   fixed ns   loop ns\n";
+    run<3>(data);
+    run<4>(data);
+    run<8>(data);
+    run<16>(data);
+}
@@ -3,10 +3,11 @@
 #include <utility>
 #include <type_traits>
 
+// (decayed like std::common_type - declval() makes xvalues, of which ?: is an xvalue too)
 template<typename T, typename U>
 struct common_type
 {
-    using type = decltype(true ? std::declval<T>() : std::declval<U>());
+    using type = std::decay_t<decltype(true ? std::declval<T>() : std::declval<U>())>;
 };
 
 template<typename T, typename U>
@@ -23,5 +23,5 @@ struct find_index_of<List, T, N, true>
 {
 };
 
-template<typename List, typename T, unsigned N>
+template<typename List, typename T, unsigned N = 0>
 constexpr inline auto find_index_of_v = find_index_of<List,T,N>::value;
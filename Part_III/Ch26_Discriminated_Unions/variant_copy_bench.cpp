@@ -0,0 +1,154 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include "variant_skel.hpp"
+
+
+// Copying variants in bulk - the growth of a std::vector by push_back, without reserve(), and
+// a std::sort of it - for variants of
+// - trivial:    int, double, Point - trivially copyable, so is the Variant: every move of
+//               std::vector and std::sort is a copy of its bytes (libstdc++ relocates with a
+//               single memmove only types which are also trivially default constructible)
+// - nontrivial: int, double, CopiedPoint - the same, but for the user-provided (noexcept)
+//               copy of CopiedPoint: every element moved or copied through the table of the
+//               alternative held; the move is noexcept, so the growth moves
+// - std:        std::variant of int, double, Point
+// Times are ns per element; build with -DCMAKE_BUILD_TYPE=Release.
+//
+// usage: variant_copy_bench [elements]
+
+struct Point
+{
+    float x;
+    float y;
+};
+
+struct CopiedPoint
+{
+    float x;
+    float y;
+
+    CopiedPoint(float px, float py) : x{px}, y{py} { }
+    CopiedPoint(CopiedPoint const& other) noexcept : x{other.x}, y{other.y} { }
+    CopiedPoint& operator=(CopiedPoint const& other)
+    {
+        x = other.x;
+        y = other.y;
+        return *this;
+    }
+};
+
+using Trivial = Variant<int, double, Point>;
+using Nontrivial = Variant<int, double, CopiedPoint>;
+
+static_assert(std::is_trivially_copyable_v<Trivial> && std::is_trivially_destructible_v<Trivial>);
+static_assert(!std::is_trivially_copyable_v<Nontrivial>);
+static_assert(std::is_nothrow_move_constructible_v<Nontrivial>);
+
+
+template<typename T>
+inline void do_not_optimize(T const& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// best of 5, in ns per element
+template<typename F>
+double time_per_element(std::size_t elements, F&& f)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < 5; ++r) {
+        best = std::min(best, f());
+    }
+    return best / static_cast<double>(elements);
+}
+
+// the sort key of a variant, by visit()
+struct Key
+{
+    double operator()(int i) const { return i; }
+    double operator()(double d) const { return d; }
+    template<typename P>
+    double operator()(P const& p) const { return static_cast<double>(p.x + p.y); }
+};
+
+template<typename V, typename MakePoint, typename Visit>
+void run(char const* name, std::vector<int> const& values, MakePoint make_point, Visit visit)
+{
+    auto const make = [&](int i) -> V {
+        switch (i % 3) {
+        case 0: return V{i};
+        case 1: return V{i * 0.5};
+        default: return V{make_point(static_cast<float>(i))};
+        }
+    };
+
+    double const growth = time_per_element(values.size(), [&] {
+        auto const start = std::chrono::steady_clock::now();
+        std::vector<V> v;
+        for (int const i : values) {
+            v.push_back(make(i));
+        }
+        do_not_optimize(v.data());
+        auto const stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count();
+    });
+
+    std::vector<V> unsorted;
+    unsorted.reserve(values.size());
+    for (int const i : values) {
+        unsorted.push_back(make(i));
+    }
+    double const sort = time_per_element(values.size(), [&] {
+        std::vector<V> v{unsorted};
+        auto const start = std::chrono::steady_clock::now();
+        std::sort(v.begin(), v.end(), [&](V const& a, V const& b) {
+            return visit(a) < visit(b);
+        });
+        do_not_optimize(v.data());
+        auto const stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count();
+    });
+
+    std::cout << std::left << std::setw(12) << name << std::right << std::setw(12) << growth
+              << std::setw(12) << sort << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t const count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> pick{0, 1'000'000};
+    std::vector<int> values(count);
+    for (int& i : values) {
+        i = pick(rng);
+    }
+
+    // (a block of the size of the vectors, allocated and freed before any timing: the allocator
+    // maps blocks this large from the system, and unmaps them when freed, until one has been
+    // freed - the first row would pay for the page faults)
+    {
+        std::vector<Trivial> warm_up;
+        warm_up.reserve(2 * count);
+        do_not_optimize(warm_up.data());
+    }
+
+    std::cout << "elements: " << count << ", ns/element\n";
+    std::cout << "                  growth        sort\n";
+    run<Trivial>("trivial", values,
+                 [](float f) { return Point{f, f}; },
+                 [](Trivial const& v) { return v.visit(Key{}); });
+    run<Nontrivial>("nontrivial", values,
+                    [](float f) { return CopiedPoint{f, f}; },
+                    [](Nontrivial const& v) { return v.visit(Key{}); });
+    run<std::variant<int, double, Point>>("std", values,
+                 [](float f) { return Point{f, f}; },
+                 [](std::variant<int, double, Point> const& v) { return std::visit(Key{}, v); });
+}
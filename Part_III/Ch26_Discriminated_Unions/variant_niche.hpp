@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>   // for std::reference_wrapper
+#include <limits>
+#include <type_traits>
+#include "typelist/typelist.hpp"
+#include "typelist/is_empty.hpp"
+#include "typelist/ifthenelse.hpp"
+#include "typelist/identity.hpp"
+
+
+// Niches - representations an object of type T never has, such as a bool byte other than 0 or 1,
+// or a reference_wrapper holding a null pointer. If one alternative of a Variant has enough of
+// them, and the other alternatives fit into the bytes around them, the Variant keeps its
+// discriminator in those bytes rather than in a byte of its own after the buffer - which, once
+// padded to the alignment of the alternatives, costs up to as much as the largest of them:
+//   struct Handle { void* p; bool owned; };                // 16 bytes
+//   template<> struct niche_traits<Handle> : member_niche<Handle, bool, offsetof(Handle, owned)> {};
+//   sizeof(Variant<Handle, int>)                            // 16 rather than 24
+// The alternative with the niche ("dataful") is recognized by its niche bytes holding a valid
+// value; every other state - empty, or another alternative - is written into them as one of
+// the invalid ones. Empty classes take no bytes, the others are placed beside the niche.
+// Alternatives without niches - double, std::int64_t, ... - keep the separate discriminator:
+// packing it into the buffer would misalign the alternatives.
+
+
+// niche_traits<T>
+/* --------------------------------------------------------------------------------------------- */
+// The niche of T: count invalid representations of the size bytes at offset in T.
+// For count > 0 the specialization provides
+//   static constexpr std::size_t offset, size;
+//   static unsigned get(unsigned char const* niche);   // k if the bytes hold invalid
+//                                                      // representation k, count if a valid T
+//   static void set(unsigned char* niche, unsigned k); // write invalid representation k
+template<typename T>
+struct niche_traits
+{
+    static constexpr unsigned count = 0;
+};
+
+// bool: the byte values 2, ..., 255
+template<>
+struct niche_traits<bool>
+{
+    static constexpr unsigned count = std::numeric_limits<unsigned char>::max() - 1;
+    static constexpr std::size_t offset = 0;
+    static constexpr std::size_t size = 1;
+
+    static unsigned get(unsigned char const* niche)
+    {
+        return *niche > 1 ? *niche - 2u : count;
+    }
+    static void set(unsigned char* niche, unsigned k)
+    {
+        *niche = static_cast<unsigned char>(k + 2);
+    }
+};
+
+// reference_wrapper: the null pointer, and the addresses below alignof(T) - not aligned for a T
+template<typename T>
+struct niche_traits<std::reference_wrapper<T>>
+{
+    static constexpr unsigned count = alignof(T);
+    static constexpr std::size_t offset = 0;
+    static constexpr std::size_t size = sizeof(std::uintptr_t);
+
+    static unsigned get(unsigned char const* niche)
+    {
+        std::uintptr_t address;
+        std::memcpy(&address, niche, sizeof(address));
+        return address < count ? static_cast<unsigned>(address) : count;
+    }
+    static void set(unsigned char* niche, unsigned k)
+    {
+        std::uintptr_t const address = k;
+        std::memcpy(niche, &address, sizeof(address));
+    }
+};
+
+// for enumerations whose enumerators are all at most Last (a niche_traits specialization
+// derives from it): the values of the underlying type after Last
+template<typename E, E Last>
+struct enum_niche
+{
+private:
+    using U = std::underlying_type_t<E>;
+    static constexpr U last = static_cast<U>(Last);
+    static constexpr auto after = static_cast<std::make_unsigned_t<U>>(
+                                    std::numeric_limits<U>::max() - last);
+    static constexpr unsigned limit = std::numeric_limits<unsigned char>::max();
+public:
+    static constexpr unsigned count = after < limit ? static_cast<unsigned>(after) : limit;
+    static constexpr std::size_t offset = 0;
+    static constexpr std::size_t size = sizeof(E);
+
+    static unsigned get(unsigned char const* niche)
+    {
+        U u;
+        std::memcpy(&u, niche, sizeof(u));
+        return u > last ? static_cast<unsigned>(u - last - 1) : count;
+    }
+    static void set(unsigned char* niche, unsigned k)
+    {
+        U const u = static_cast<U>(last + 1 + static_cast<U>(k));
+        std::memcpy(niche, &u, sizeof(u));
+    }
+};
+
+// for classes (a niche_traits specialization derives from it): the niche of the member of
+// type M at Offset
+template<typename T, typename M, std::size_t Offset>
+struct member_niche
+{
+    static constexpr unsigned count = niche_traits<M>::count;
+    static constexpr std::size_t offset = Offset + niche_traits<M>::offset;
+    static constexpr std::size_t size = niche_traits<M>::size;
+
+    static unsigned get(unsigned char const* niche) { return niche_traits<M>::get(niche); }
+    static void set(unsigned char* niche, unsigned k) { niche_traits<M>::set(niche, k); }
+};
+/* --------------------------------------------------------------------------------------------- */
+
+
+// The layout around the niche of the dataful alternative D
+/* --------------------------------------------------------------------------------------------- */
+constexpr inline std::size_t no_niche_placement = std::numeric_limits<std::size_t>::max();
+
+// the offset of alternative T in the buffer - before the niche bytes of D, or after them -
+// or no_niche_placement if it does not fit in sizeof(D) bytes beside them
+template<typename D, typename T>
+constexpr std::size_t niche_placement()
+{
+    using N = niche_traits<D>;
+    if constexpr (std::is_same_v<D, T> || std::is_empty_v<T>) {
+        return 0;
+    }
+    else if constexpr (sizeof(T) <= N::offset) {
+        return 0;
+    }
+    else {
+        constexpr std::size_t after = (N::offset + N::size + alignof(T) - 1) / alignof(T)
+                                      * alignof(T);
+        return after + sizeof(T) <= sizeof(D) ? after : no_niche_placement;
+    }
+}
+
+// Can D hold the discriminator of Variant<Types...>: invalid representations for the empty
+// state and every other alternative, and room for the other alternatives
+template<typename D, typename... Types>
+constexpr bool niche_fits()
+{
+    if constexpr (niche_traits<D>::count < sizeof...(Types)) {
+        return false;
+    }
+    else {
+        return ((niche_placement<D, Types>() != no_niche_placement) && ...);
+    }
+}
+
+// the first of Candidates that fits, void if none does
+template<typename Candidates, typename List, bool = is_empty_v<Candidates>>
+struct niche_alternative;
+
+template<typename Candidates, typename... Types>
+struct niche_alternative<Candidates, typelist<Types...>, false>
+    : if_then_else_t<niche_fits<front_t<Candidates>, Types...>(),
+                     identity<front_t<Candidates>>,
+                     niche_alternative<pop_front_t<Candidates>, typelist<Types...>>>
+{
+};
+
+template<typename Candidates, typename List>
+struct niche_alternative<Candidates, List, true>
+{
+    using type = void;
+};
+
+template<typename... Types>
+using niche_alternative_t = typename niche_alternative<typelist<Types...>, typelist<Types...>>::type;
+/* --------------------------------------------------------------------------------------------- */
+
+
+// unit tests
+namespace unit_test_niche
+{
+    enum class Color : unsigned char { red, green, blue };
+    struct Flagged { bool valid; double value; };
+    struct Empty { };
+
+    static_assert(niche_traits<int>::count == 0);
+    static_assert(niche_traits<bool>::count == 254);
+    static_assert(enum_niche<Color, Color::blue>::count == 253);
+    static_assert(member_niche<Flagged, bool, 0>::count == 254);
+
+    static_assert(niche_fits<bool, bool, Empty>());
+    static_assert(!niche_fits<bool, bool, int>());      // int does not fit beside a bool
+    static_assert(niche_fits<std::reference_wrapper<int>, std::reference_wrapper<int>, Empty>());
+    static_assert(!niche_fits<std::reference_wrapper<char>,
+                              std::reference_wrapper<char>, Empty>());        // null only
+    static_assert(std::is_same_v<niche_alternative_t<Empty, bool>, bool>);
+    static_assert(std::is_same_v<niche_alternative_t<double, long>, void>);
+} // namespace unit_test_niche
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <iomanip>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "variant_skel.hpp"
+
+
+// sizeof(Variant<...>) for common sets of alternatives: with the discriminator in a byte of its
+// own after the buffer, and as laid out - in the niche of an alternative where there is one
+// (see variant_niche.hpp). The static_asserts keep the table from regressing.
+
+struct Empty { };
+
+// a pointer and an ownership flag - the bool is the niche
+struct Handle
+{
+    void* p;
+    bool owned;
+};
+template<> struct niche_traits<Handle> : member_niche<Handle, bool, offsetof(Handle, owned)> { };
+
+// a value and its validity - the alternatives of a Variant fit beside the flag
+struct Flagged
+{
+    bool valid;
+    double value;
+};
+template<> struct niche_traits<Flagged> : member_niche<Flagged, bool, offsetof(Flagged, valid)> { };
+
+enum class Color : unsigned char { red, green, blue };
+template<> struct niche_traits<Color> : enum_niche<Color, Color::blue> { };
+
+struct ErrorCode
+{
+    int code;
+};
+
+
+// the size of Variant<Types...> without the niche
+template<typename... Types>
+constexpr std::size_t separate_size = sizeof(SeparateDiscriminatorStorage<Types...>);
+
+// without a niche: unchanged
+static_assert(sizeof(Variant<double, std::int64_t>) == 2 * sizeof(double));
+static_assert(sizeof(Variant<int, float>) == 2 * sizeof(int));
+static_assert(sizeof(Variant<char, short>) == 2 * sizeof(short));
+static_assert(sizeof(Variant<std::string, int>) == separate_size<std::string, int>);
+// in a niche
+static_assert(sizeof(Variant<bool, Empty>) == 1);
+static_assert(sizeof(Variant<Color, Empty>) == 1);
+static_assert(sizeof(Variant<std::reference_wrapper<int>, Empty>) == sizeof(int*));
+static_assert(sizeof(Variant<Handle, ErrorCode>) == sizeof(Handle));
+static_assert(sizeof(Variant<Handle, int, float, Empty>) == sizeof(Handle));
+static_assert(sizeof(Variant<Flagged, int, float>) == sizeof(Flagged));
+// bool's niche, but no room for the double beside it
+static_assert(sizeof(Variant<bool, double>) == separate_size<bool, double>);
+
+
+template<typename... Types>
+void row(char const* alternatives)
+{
+    std::cout << std::left << std::setw(42) << alternatives << std::right
+              << std::setw(10) << separate_size<Types...>
+              << std::setw(10) << sizeof(Variant<Types...>) << '\n';
+}
+
+int main()
+{
+    std::cout << std::left << std::setw(42) << "alternatives" << std::right
+              << std::setw(10) << "separate" << std::setw(10) << "sizeof" << '\n';
+    row<double, std::int64_t>("double, int64_t");
+    row<int, float>("int, float");
+    row<char, short>("char, short");
+    row<std::string, int>("std::string, int");
+    row<bool, double>("bool, double");
+    row<bool, Empty>("bool, Empty");
+    row<Color, Empty>("Color, Empty");
+    row<std::reference_wrapper<int>, Empty>("std::reference_wrapper<int>, Empty");
+    row<Handle, ErrorCode>("Handle, ErrorCode");
+    row<Handle, int, float, Empty>("Handle, int, float, Empty");
+    row<Flagged, int, float>("Flagged, int, float");
+}
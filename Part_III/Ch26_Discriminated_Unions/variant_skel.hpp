@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cassert>
+#include <cstddef>
 #include <exception>    // for get()
+#include <type_traits>
+#include <utility>
 #include "variant_fwd.hpp"
 #include "variantstorage.hpp"
 #include "variantchoice.hpp"
@@ -39,8 +43,9 @@ public:
     using VariantChoice<Types, Types...>::VariantChoice...;
 
     Variant();
-    Variant(Variant const& source);
-    Variant(Variant&& source);
+    // (copied, moved and destroyed by VariantStorage - trivially, if Types... all are)
+    Variant(Variant const& source) = default;
+    Variant(Variant&& source) = default;
 
     template<typename... SourceTypes>
     Variant(Variant<SourceTypes...> const& source);
@@ -50,18 +55,29 @@ public:
 
     // inherit all assignment operators
     using VariantChoice<Types,Types...>::operator=...;
-    Variant& operator=(Variant const& source);
-    Variant& operator=(Variant&& source);
+    Variant& operator=(Variant const& source) = default;
+    Variant& operator=(Variant&& source) = default;
     template<typename... SourceTypes>
     Variant& operator=(Variant<SourceTypes...> const& source);
     template<typename... SourceTypes>
     Variant& operator=(Variant<SourceTypes...>&& source);
 
     bool empty() const;
+    // 1 + the index of the alternative held, 0 if empty
+    unsigned discriminator() const { return this->getDiscriminator(); }
 
-    ~Variant() { destroy(); }
+    ~Variant() = default;
 
     void destroy();
+
+private:
+    // see visit() below
+    template<typename R, typename Self, typename Visitor>
+    static R visitTable(Self&& self, Visitor&& vis);
+    template<typename R, typename Self, typename Visitor>
+    [[noreturn]] static R visitEmpty(Self&& self, Visitor&& vis);
+    template<typename R, typename Self, typename Visitor, typename T>
+    static R visitAlternative(Self&& self, Visitor&& vis);
 };
 
 
@@ -87,8 +103,10 @@ bool Variant<Types...>::empty() const
 template<typename... Types>
 void Variant<Types...>::destroy()
 {
-    // call destroy() on each VariantChoice base class; at most one will succeed:
-    (... , VariantChoice<Types, Types...>::destroy());
+    if constexpr (!(std::is_trivially_destructible_v<Types> && ...)) {
+        // call destroy() on each VariantChoice base class; at most one will succeed:
+        (... , VariantChoice<Types, Types...>::destroy());
+    }
     // indicate that the variant does not store a value
     this->setDiscriminator(0);
 }
@@ -138,6 +156,8 @@ T&& Variant<Types...>::get() &&
 
 // visit
 /* --------------------------------------------------------------------------------------------- */
+// the straightforward visit: a chain of is<T>() tests, one alternative after the other
+// (kept for comparison, see visit_bench.cpp)
 template<typename R, typename V, typename Visitor,
          typename Head, typename... Tail>
 R variantVisitImpl(V&& variant, Visitor&& vis, typelist<Head,Tail...>)
@@ -148,22 +168,67 @@ R variantVisitImpl(V&& variant, Visitor&& vis, typelist<Head,Tail...>)
                     std::forward<V>(variant).template get<Head>()));
     }
     else if constexpr (sizeof...(Tail) > 0) {
-        return variantVisitImpl<R>(std::forward<V>(variant)
-                                  std::forward<Visitor>(vis),
-                                  typelist<Tail...>{});
+        return variantVisitImpl<R>(std::forward<V>(variant),
+                                   std::forward<Visitor>(vis),
+                                   typelist<Tail...>{});
     }
     else {
         throw EmptyVariant{};
     }
 }
 
+// Variant::visit() jumps to the alternative held through a table of functions indexed by the
+// discriminator - one per alternative, generated by a pack expansion - so it takes the
+// same time whichever alternative is held, and however many there are.
+// Up to visit_chain_limit alternatives the chain above is as fast, and the visitor is inlined.
+constexpr inline std::size_t visit_chain_limit = 4;
+
+template<typename... Types>
+  template<typename R, typename Self, typename Visitor>
+R Variant<Types...>::visitEmpty(Self&&, Visitor&&)
+{
+    throw EmptyVariant{};
+}
+
+template<typename... Types>
+  template<typename R, typename Self, typename Visitor, typename T>
+R Variant<Types...>::visitAlternative(Self&& self, Visitor&& vis)
+{
+    // (the discriminator has been checked already, unlike by get())
+    if constexpr (std::is_lvalue_reference_v<Self>) {
+        return static_cast<R>(std::forward<Visitor>(vis)(*self.template getBufferAs<T>()));
+    }
+    else {
+        return static_cast<R>(
+                std::forward<Visitor>(vis)(std::move(*self.template getBufferAs<T>())));
+    }
+}
+
+template<typename... Types>
+  template<typename R, typename Self, typename Visitor>
+R Variant<Types...>::visitTable(Self&& self, Visitor&& vis)
+{
+    using Alternative = R (*)(Self&&, Visitor&&);
+    // entry 0 for the empty variant, entry d for the alternative with discriminator d
+    static constexpr Alternative table[] = {
+        &Variant::template visitEmpty<R, Self, Visitor>,
+        &Variant::template visitAlternative<R, Self, Visitor, Types>...
+    };
+    return table[self.getDiscriminator()](std::forward<Self>(self), std::forward<Visitor>(vis));
+}
+
 template<typename... Types>
   template<typename R, typename Visitor>
 VisitResult<R, Visitor, Types&...>
 Variant<Types...>::visit(Visitor&& vis) &
 {
     using Result = VisitResult<R, Visitor, Types&...>;
-    return variantVisitImpl<Result>(*this, std::forward<Visitor>(vis), typelist<Types...>{});
+    if constexpr (sizeof...(Types) <= visit_chain_limit) {
+        return variantVisitImpl<Result>(*this, std::forward<Visitor>(vis), typelist<Types...>{});
+    }
+    else {
+        return visitTable<Result>(*this, std::forward<Visitor>(vis));
+    }
 }
 
 template<typename... Types>
@@ -172,7 +237,12 @@ VisitResult<R, Visitor, Types const&...>
 Variant<Types...>::visit(Visitor&& vis) const&
 {
     using Result = VisitResult<R, Visitor, Types const&...>;
-    return variantVisitImpl<Result>(*this, std::forward<Visitor>(vis), typelist<Types...>{});
+    if constexpr (sizeof...(Types) <= visit_chain_limit) {
+        return variantVisitImpl<Result>(*this, std::forward<Visitor>(vis), typelist<Types...>{});
+    }
+    else {
+        return visitTable<Result>(*this, std::forward<Visitor>(vis));
+    }
 }
 
 template<typename... Types>
@@ -181,9 +251,12 @@ VisitResult<R, Visitor, Types&&...>
 Variant<Types...>::visit(Visitor&& vis) &&
 {
     using Result = VisitResult<R, Visitor, Types&&...>;
-    return variantVisitImpl<Result>(std::move(*this),
-                                    std::forward<Visitor>(vis),
-                                    typelist<Types...>{});
+    if constexpr (sizeof...(Types) <= visit_chain_limit) {
+        return variantVisitImpl<Result>(std::move(*this), std::forward<Visitor>(vis), typelist<Types...>{});
+    }
+    else {
+        return visitTable<Result>(std::move(*this), std::forward<Visitor>(vis));
+    }
 }
 /* --------------------------------------------------------------------------------------------- */
 
@@ -196,44 +269,39 @@ Variant<Types...>::Variant()
 }
 
 template<typename... Types>
-Variant<Types...>::Variant(Variant const& source)
+  template<typename... SourceTypes>
+Variant<Types...>::Variant(Variant<SourceTypes...> const& source)
 {
     if (!source.empty()) {
-        source.visit([&](auto const& value)) {
+        source.visit([&](auto const& value) {
             *this = value;
-        }
+        });
     }
 }
 
 template<typename... Types>
-Variant<Types...>::Variant(Variant&& source)
+  template<typename... SourceTypes>
+Variant<Types...>::Variant(Variant<SourceTypes...>&& source)
 {
     if (!source.empty()) {
-        source.visit([&](auto&& value)) {
+        std::move(source).visit([&](auto&& value) {
             *this = std::move(value);
-        }
+        });
     }
 }
+/* --------------------------------------------------------------------------------------------- */
 
+// Assignment
+/* --------------------------------------------------------------------------------------------- */
 template<typename... Types>
   template<typename... SourceTypes>
-Variant<Types...>::Variant(Variant<SourceTypes...> const& source)
+Variant<Types...>& Variant<Types...>::operator= (Variant<SourceTypes...> const& source)
 {
-    if !(source.empty()) {
+    if (!source.empty()) {
         source.visit([&](auto const& value) {
             *this = value;
         });
     }
-}
-
-template<typename... Types>
-Variant<Types...>& Variant<Types...>::operator= (Variant const& source)
-{
-    if (!source.empty()) {
-        source.visit([&](auto const& value){
-            *this = value;
-        })
-    }
     else {
         destroy();
     }
@@ -241,16 +309,17 @@ Variant<Types...>& Variant<Types...>::operator= (Variant const& source)
 }
 
 template<typename... Types>
-Variant<Types...>& Variant<Types...>::operator= (Variant&& source)
+  template<typename... SourceTypes>
+Variant<Types...>& Variant<Types...>::operator= (Variant<SourceTypes...>&& source)
 {
     if (!source.empty()) {
-        source.visit([&](auto&& value){
+        std::move(source).visit([&](auto&& value) {
             *this = std::move(value);
-        })
+        });
     }
     else {
         destroy();
     }
     return *this;
 }
-/* --------------------------------------------------------------------------------------------- */
\ No newline at end of file
+/* --------------------------------------------------------------------------------------------- */
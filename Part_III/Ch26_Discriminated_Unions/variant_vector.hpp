@@ -0,0 +1,281 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "variant_skel.hpp"
+#include "findindexof.hpp"
+#include "typelist/typelist.hpp"
+
+
+// VariantVector<Types...> - a sequence of values of the alternatives Types..., like
+// std::vector<Variant<Types...>>, stored as one contiguous array per alternative (struct of
+// arrays) and an order index: for every element, its discriminator - as in VariantChoice - and
+// its position in the array of its alternative, 5 bytes in all.
+// Every element takes only the size of its own alternative rather than that of the largest one,
+// and the elements of one alternative can be processed without looking at the others:
+//   VariantVector<Circle, Square> shapes;
+//   shapes.push_back(Circle{1.0});
+//   shapes.for_each_of<Circle>([](Circle& c) { ... });  // a plain loop over the circles
+//   shapes.batch_visit(vis);     // vis(x) for all circles, then for all squares
+//   shapes.for_each(vis);        // vis(x) for every element, in the order of insertion
+//   Variant<Circle, Square> v = shapes.at(i);
+// batch_visit() resolves the overload of the visitor once per alternative, for a run of
+// elements, rather than once per element like for_each(), which jumps through a table indexed
+// by the discriminator at every element.
+// Elements are appended - or removed all at once, by clear().
+template<typename... Types>
+class VariantVector
+{
+public:
+    using size_type = std::size_t;
+    using variant_type = Variant<Types...>;
+
+    // the discriminator of T, 1 + its index in Types...
+    template<typename T>
+    static constexpr unsigned char discriminator_of =
+        static_cast<unsigned char>(find_index_of_v<typelist<Types...>, T> + 1);
+
+    size_type size() const { return discriminators_.size(); }
+    bool empty() const { return discriminators_.empty(); }
+    void clear();
+
+    // the number of elements of alternative T, and their array
+    template<typename T> size_type count() const { return elements<T>().size(); }
+    template<typename T> std::vector<T>& elements() { return std::get<std::vector<T>>(arrays_); }
+    template<typename T> std::vector<T> const& elements() const
+    {
+        return std::get<std::vector<T>>(arrays_);
+    }
+
+    // (std::length_error beyond 2^32 elements of one alternative)
+    template<typename T, typename = std::enable_if_t<(std::is_same_v<std::decay_t<T>, Types> || ...)>>
+    void push_back(T&& value);
+    template<typename T, typename... Args>
+    T& emplace_back(Args&&... args);
+    void push_back(variant_type const& value);
+
+    // the discriminator of element i, and the element itself
+    unsigned discriminator(size_type i) const { return discriminators_[i]; }
+    template<typename T> bool is(size_type i) const;
+    template<typename T> T& get(size_type i);
+    template<typename T> T const& get(size_type i) const;
+    variant_type at(size_type i) const;
+
+    // f(x) for every element x of alternative T
+    template<typename T, typename F>
+    void for_each_of(F&& f);
+    template<typename T, typename F>
+    void for_each_of(F&& f) const;
+
+    // vis(x) for every element x, by alternative
+    template<typename Visitor>
+    void batch_visit(Visitor&& vis);
+    template<typename Visitor>
+    void batch_visit(Visitor&& vis) const;
+
+    // vis(x) for every element x, in order
+    template<typename Visitor>
+    void for_each(Visitor&& vis);
+    template<typename Visitor>
+    void for_each(Visitor&& vis) const;
+
+private:
+    // vis(x) for the element x at index in the array of the alternative with discriminator d
+    template<typename R, typename Self, typename Visitor>
+    static R dispatch(Self& self, unsigned char d, std::uint32_t index, Visitor& vis);
+    template<typename R, typename Self, typename Visitor, typename T>
+    static R visitAt(Self& self, std::uint32_t index, Visitor& vis);
+
+    template<typename T>
+    void checkRoom() const;
+    template<typename T>
+    void appended();
+
+    std::tuple<std::vector<Types>...> arrays_{};
+    // the order index: for element i, its discriminator and its index in the array of its
+    // alternative (two arrays, as a struct of the two would be padded to 8 bytes)
+    std::vector<unsigned char> discriminators_{};
+    std::vector<std::uint32_t> indices_{};
+};
+
+
+// insertion
+/* --------------------------------------------------------------------------------------------- */
+// (the index in the array of an alternative is stored in 32 bits)
+template<typename... Types>
+  template<typename T>
+void VariantVector<Types...>::checkRoom() const
+{
+    if (elements<T>().size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("VariantVector: too many elements of one alternative");
+    }
+}
+
+template<typename... Types>
+  template<typename T>
+void VariantVector<Types...>::appended()
+{
+    discriminators_.push_back(discriminator_of<T>);
+    indices_.push_back(static_cast<std::uint32_t>(elements<T>().size() - 1));
+}
+
+template<typename... Types>
+  template<typename T, typename>
+void VariantVector<Types...>::push_back(T&& value)
+{
+    using U = std::decay_t<T>;
+    checkRoom<U>();
+    elements<U>().push_back(std::forward<T>(value));
+    appended<U>();
+}
+
+template<typename... Types>
+  template<typename T, typename... Args>
+T& VariantVector<Types...>::emplace_back(Args&&... args)
+{
+    checkRoom<T>();
+    elements<T>().emplace_back(std::forward<Args>(args)...);
+    appended<T>();
+    return elements<T>().back();
+}
+
+template<typename... Types>
+void VariantVector<Types...>::push_back(variant_type const& value)
+{
+    value.visit([this](auto const& x) {
+        push_back(x);
+    });
+}
+
+template<typename... Types>
+void VariantVector<Types...>::clear()
+{
+    (elements<Types>().clear(), ...);
+    discriminators_.clear();
+    indices_.clear();
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// access
+/* --------------------------------------------------------------------------------------------- */
+template<typename... Types>
+  template<typename T>
+bool VariantVector<Types...>::is(size_type i) const
+{
+    return discriminators_[i] == discriminator_of<T>;
+}
+
+template<typename... Types>
+  template<typename T>
+T& VariantVector<Types...>::get(size_type i)
+{
+    assert(is<T>(i));
+    return elements<T>()[indices_[i]];
+}
+
+template<typename... Types>
+  template<typename T>
+T const& VariantVector<Types...>::get(size_type i) const
+{
+    assert(is<T>(i));
+    return elements<T>()[indices_[i]];
+}
+
+template<typename... Types>
+auto VariantVector<Types...>::at(size_type i) const -> variant_type
+{
+    auto const copy = [](auto const& x) {
+        return variant_type{x};
+    };
+    return dispatch<variant_type>(*this, discriminators_[i], indices_[i], copy);
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// iteration
+/* --------------------------------------------------------------------------------------------- */
+template<typename... Types>
+  template<typename T, typename F>
+void VariantVector<Types...>::for_each_of(F&& f)
+{
+    for (T& x : elements<T>()) {
+        f(x);
+    }
+}
+
+template<typename... Types>
+  template<typename T, typename F>
+void VariantVector<Types...>::for_each_of(F&& f) const
+{
+    for (T const& x : elements<T>()) {
+        f(x);
+    }
+}
+
+template<typename... Types>
+  template<typename Visitor>
+void VariantVector<Types...>::batch_visit(Visitor&& vis)
+{
+    (for_each_of<Types>(vis), ...);
+}
+
+template<typename... Types>
+  template<typename Visitor>
+void VariantVector<Types...>::batch_visit(Visitor&& vis) const
+{
+    (for_each_of<Types>(vis), ...);
+}
+
+template<typename... Types>
+  template<typename R, typename Self, typename Visitor, typename T>
+R VariantVector<Types...>::visitAt(Self& self, std::uint32_t index, Visitor& vis)
+{
+    // (for_each() ignores whatever the visitor returns)
+    if constexpr (std::is_void_v<R>) {
+        vis(self.template elements<T>()[index]);
+    }
+    else {
+        return vis(self.template elements<T>()[index]);
+    }
+}
+
+// a jump through a table indexed by the discriminator, as Variant::visit()
+template<typename... Types>
+  template<typename R, typename Self, typename Visitor>
+R VariantVector<Types...>::dispatch(Self& self, unsigned char d, std::uint32_t index,
+                                    Visitor& vis)
+{
+    using Alternative = R (*)(Self&, std::uint32_t, Visitor&);
+    // (entry 0 for the discriminator of no alternative, never stored)
+    static constexpr Alternative table[] = {
+        nullptr, &VariantVector::template visitAt<R, Self, Visitor, Types>...
+    };
+    return table[d](self, index, vis);
+}
+
+template<typename... Types>
+  template<typename Visitor>
+void VariantVector<Types...>::for_each(Visitor&& vis)
+{
+    for (size_type i = 0; i < size(); ++i) {
+        dispatch<void>(*this, discriminators_[i], indices_[i], vis);
+    }
+}
+
+template<typename... Types>
+  template<typename Visitor>
+void VariantVector<Types...>::for_each(Visitor&& vis) const
+{
+    for (size_type i = 0; i < size(); ++i) {
+        dispatch<void>(*this, discriminators_[i], indices_[i], vis);
+    }
+}
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+#include "variant_skel.hpp"
+#include "variant_vector.hpp"
+
+
+// A batch of shapes - circles, rectangles and triangles in random order - in a
+// std::vector<Variant<...>> and in a VariantVector<...>:
+// - all:      the sum of the areas of all shapes
+//             vector: Variant::visit of every element
+//             for_each: VariantVector::for_each, in order
+//             batch: VariantVector::batch_visit, by alternative
+// - circles:  the sum of the radii of the circles only
+//             vector: is<Circle>() tested for every element
+//             for_each_of: VariantVector::for_each_of<Circle>
+// Times are ns per shape; build with -DCMAKE_BUILD_TYPE=Release.
+//
+// usage: variant_vector_bench [shapes]
+
+struct Circle
+{
+    double r;
+};
+
+struct Rectangle
+{
+    double w;
+    double h;
+};
+
+struct Triangle
+{
+    double a;
+    double b;
+    double c;
+};
+
+using Shape = Variant<Circle, Rectangle, Triangle>;
+using Shapes = VariantVector<Circle, Rectangle, Triangle>;
+
+struct Area
+{
+    double operator()(Circle const& s) const { return 3.14159265358979 * s.r * s.r; }
+    double operator()(Rectangle const& s) const { return s.w * s.h; }
+    double operator()(Triangle const& s) const
+    {
+        // (not Heron's formula - any arithmetic of the three sides will do)
+        return 0.25 * (s.a + s.b) * (s.b + s.c) - s.a * s.c;
+    }
+};
+
+
+template<typename T>
+inline void do_not_optimize(T const& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// best of 5, in ns per shape
+template<typename F>
+double time_per_shape(std::size_t shapes, F&& f)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < 5; ++r) {
+        auto const start = std::chrono::steady_clock::now();
+        double const sum = f();
+        do_not_optimize(sum);
+        auto const stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    return best / static_cast<double>(shapes);
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t const count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> pick{0, 2};
+    std::uniform_real_distribution<double> length{1.0, 2.0};
+    std::vector<Shape> vector;
+    Shapes shapes;
+    vector.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        switch (pick(rng)) {
+        case 0: {
+            Circle const s{length(rng)};
+            vector.push_back(s);
+            shapes.push_back(s);
+            break;
+        }
+        case 1: {
+            Rectangle const s{length(rng), length(rng)};
+            vector.push_back(s);
+            shapes.push_back(s);
+            break;
+        }
+        default: {
+            Triangle const s{length(rng), length(rng), length(rng)};
+            vector.push_back(s);
+            shapes.push_back(s);
+            break;
+        }
+        }
+    }
+
+    std::size_t const vector_bytes = count * sizeof(Shape);
+    std::size_t const shapes_bytes = shapes.count<Circle>() * sizeof(Circle)
+                                     + shapes.count<Rectangle>() * sizeof(Rectangle)
+                                     + shapes.count<Triangle>() * sizeof(Triangle)
+                                     + count * (sizeof(unsigned char) + sizeof(std::uint32_t));
+    std::cout << "shapes: " << count << ", bytes/shape: vector " << vector_bytes / count
+              << ", VariantVector " << static_cast<double>(shapes_bytes) / static_cast<double>(count)
+              << "\n\n";
+
+    double const all_vector = time_per_shape(count, [&] {
+        double sum = 0.0;
+        for (Shape const& s : vector) {
+            sum += s.visit(Area{});
+        }
+        return sum;
+    });
+    double const all_for_each = time_per_shape(count, [&] {
+        double sum = 0.0;
+        shapes.for_each([&sum](auto const& s) { sum += Area{}(s); });
+        return sum;
+    });
+    double const all_batch = time_per_shape(count, [&] {
+        double sum = 0.0;
+        shapes.batch_visit([&sum](auto const& s) { sum += Area{}(s); });
+        return sum;
+    });
+
+    double const circles_vector = time_per_shape(count, [&] {
+        double sum = 0.0;
+        for (Shape const& s : vector) {
+            if (s.is<Circle>()) {
+                sum += s.get<Circle>().r;
+            }
+        }
+        return sum;
+    });
+    double const circles_for_each_of = time_per_shape(count, [&] {
+        double sum = 0.0;
+        shapes.for_each_of<Circle>([&sum](Circle const& c) { sum += c.r; });
+        return sum;
+    });
+
+    std::cout << "ns/shape      vector    for_each       batch  for_each_of\n";
+    std::cout << std::left << std::setw(8) << "all" << std::right << std::setw(12) << all_vector
+              << std::setw(12) << all_for_each << std::setw(12) << all_batch << '\n';
+    std::cout << std::left << std::setw(8) << "circles" << std::right
+              << std::setw(12) << circles_vector << std::setw(37) << circles_for_each_of << '\n';
+}
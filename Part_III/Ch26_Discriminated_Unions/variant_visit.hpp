@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "variant_skel.hpp"
+#include "variant_visit_result.hpp"
+#include "typelist/typelist.hpp"
+#include "typelist/accumulate.hpp"
+#include "typelist/nth_element.hpp"
+
+
+// visit(vis, v1, v2, ...) - visiting several variants at once: vis is called with the
+// alternatives held by each of them,
+//   visit(Dispatch{}, message, state);     // Dispatch::operator()(Ping const&, Idle const&), ...
+// instead of a visit() nested in a visit(), which tests the alternatives of the inner variant
+// once for every alternative of the outer one.
+// One function is instantiated per combination of alternatives - N1×N2×... of them - and
+// stored in a table indexed by the combined discriminator (d1-1)·N2·N3... + (d2-1)·N3... + ...,
+// so the call is a single indirect jump, whatever the number of variants.
+//
+// The table is what bounds the compile time: every entry is a function instantiated and
+// compiled, and the result type is computed over every combination. visit_table_limit caps the
+// total number of entries - 32×32, or 10×10×10 - at which a visit compiles in about as long as
+// a std::visit of the same variants (some 5 s at -O2, and 8 KB of table); split the visit, or
+// group the alternatives, rather than raise it.
+constexpr inline std::size_t visit_table_limit = 1024;
+
+
+// the alternatives of a Variant
+/* --------------------------------------------------------------------------------------------- */
+template<typename V>
+struct variant_alternatives;
+
+template<typename... Types>
+struct variant_alternatives<Variant<Types...>>
+{
+    using type = typelist<Types...>;
+    static constexpr std::size_t size = sizeof...(Types);
+};
+
+template<typename V>
+using variant_alternatives_t = typename variant_alternatives<std::decay_t<V>>::type;
+
+template<typename V>
+constexpr inline std::size_t variant_size_v = variant_alternatives<std::decay_t<V>>::size;
+/* --------------------------------------------------------------------------------------------- */
+
+
+// Combination J of the alternatives of the variants Vs...: the alternative of the K-th of
+// them, as it is passed to the visitor - T&, T const& or T&& like the variant itself.
+template<std::size_t J, typename... Vs>
+struct VisitCombination
+{
+private:
+    static constexpr std::size_t sizes[] = {variant_size_v<Vs>...};
+
+    // the index of the alternative of the K-th variant
+    static constexpr unsigned index(std::size_t K)
+    {
+        std::size_t stride = 1;
+        for (std::size_t k = K + 1; k < sizeof...(Vs); ++k) {
+            stride *= sizes[k];
+        }
+        return static_cast<unsigned>(J / stride % sizes[K]);
+    }
+
+public:
+    template<std::size_t K>
+    using variant = nth_element_t<typelist<Vs...>, static_cast<unsigned>(K)>;
+
+    template<std::size_t K>
+    using alternative = nth_element_t<variant_alternatives_t<variant<K>>, index(K)>;
+
+    template<std::size_t K>
+    using argument = decltype(std::declval<variant<K>>().template get<alternative<K>>());
+};
+
+
+// the result type, if not given explicitly: the common type of the results of all combinations
+/* --------------------------------------------------------------------------------------------- */
+template<typename Visitor, std::size_t J, typename Seq, typename... Vs>
+struct CombinationResultT;
+
+template<typename Visitor, std::size_t J, std::size_t... K, typename... Vs>
+struct CombinationResultT<Visitor, J, std::index_sequence<K...>, Vs...>
+{
+    using Combination = VisitCombination<J, Vs...>;
+    using type = decltype(std::declval<Visitor>()(
+                    std::declval<typename Combination::template argument<K>>()...));
+};
+
+// (accumulated one row of combinations - those of one alternative of the first variant - at a
+// time, as the accumulation of all of them at once recurses once per combination)
+template<typename List>
+using CommonTypeOf = accumulate_t<pop_front_t<List>, common_type, front_t<List>>;
+
+template<typename Visitor, std::size_t Row, typename Seq, typename... Vs>
+struct RowResultT;
+
+template<typename Visitor, std::size_t Row, std::size_t... J, typename... Vs>
+struct RowResultT<Visitor, Row, std::index_sequence<J...>, Vs...>
+{
+    using type = CommonTypeOf<typelist<typename CombinationResultT<
+                    Visitor, Row * sizeof...(J) + J, std::index_sequence_for<Vs...>, Vs...>::type...>>;
+};
+
+template<typename R, typename Visitor, typename Seq, typename... Vs>
+struct MultiVisitResultT
+{
+    using type = R;
+};
+
+template<typename Visitor, std::size_t... Row, typename V, typename... Vs>
+struct MultiVisitResultT<ComputedResultType, Visitor, std::index_sequence<Row...>, V, Vs...>
+{
+    using type = CommonTypeOf<typelist<typename RowResultT<
+                    Visitor, Row, std::make_index_sequence<(variant_size_v<Vs> * ... * 1)>,
+                    V, Vs...>::type...>>;
+};
+
+template<typename R, typename Visitor, typename... Vs>
+using MultiVisitResult = typename MultiVisitResultT<
+    R, Visitor, std::make_index_sequence<variant_size_v<front_t<typelist<Vs...>>>>, Vs...>::type;
+/* --------------------------------------------------------------------------------------------- */
+
+
+// the table
+/* --------------------------------------------------------------------------------------------- */
+// the entry for combination J
+template<typename R, std::size_t J, typename Visitor, typename... Vs, std::size_t... K>
+R visitCombinationImpl(Visitor&& vis, std::index_sequence<K...>, Vs&&... vs)
+{
+    using Combination = VisitCombination<J, Vs...>;
+    return static_cast<R>(std::forward<Visitor>(vis)(
+                std::forward<Vs>(vs).template get<typename Combination::template alternative<K>>()...));
+}
+
+template<typename R, std::size_t J, typename Visitor, typename... Vs>
+R visitCombination(Visitor&& vis, Vs&&... vs)
+{
+    return visitCombinationImpl<R, J>(std::forward<Visitor>(vis), std::index_sequence_for<Vs...>{},
+                                      std::forward<Vs>(vs)...);
+}
+
+template<typename R, typename Visitor, typename... Vs>
+struct VisitTable
+{
+    using Entry = R (*)(Visitor&&, Vs&&...);
+
+    template<std::size_t... J>
+    struct Entries
+    {
+        static constexpr Entry table[] = {&visitCombination<R, J, Visitor, Vs...>...};
+    };
+
+    template<std::size_t... J>
+    static constexpr Entry const* make(std::index_sequence<J...>)
+    {
+        return Entries<J...>::table;
+    }
+};
+/* --------------------------------------------------------------------------------------------- */
+
+
+// (the result type is MultiVisitResult<R, Visitor, Vs&&...> - computed in the body, after the
+// size of the table has been checked)
+template<typename R = ComputedResultType, typename Visitor, typename... Vs>
+decltype(auto) visit(Visitor&& vis, Vs&&... vs)
+{
+    static_assert(sizeof...(Vs) > 0, "visit: no variant to visit");
+    constexpr std::size_t combinations = (variant_size_v<Vs> * ... * 1);
+    static_assert(combinations <= visit_table_limit,
+                  "visit: too many combinations of alternatives, see visit_table_limit");
+
+    using Result = MultiVisitResult<R, Visitor, Vs&&...>;
+    constexpr auto table = VisitTable<Result, Visitor, Vs&&...>::make(
+                                std::make_index_sequence<combinations>{});
+
+    if ((vs.empty() || ...)) {
+        throw EmptyVariant{};
+    }
+    std::size_t index = 0;
+    ((index = index * variant_size_v<Vs> + (vs.discriminator() - 1u)), ...);
+    return table[index](std::forward<Visitor>(vis), std::forward<Vs>(vs)...);
+}
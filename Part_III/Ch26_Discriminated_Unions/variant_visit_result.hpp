@@ -22,9 +22,13 @@ using VisitResult = typename VisitResultT<R, Visitor, ElementTypes...>::type;
 template<typename Visitor, typename T>
 using VisitElementResult = decltype(std::declval<Visitor>()(std::declval<T>()));
 
+// tag type requesting that the result type be computed from the visitor
+// (the default template argument of Variant::visit()):
+class ComputedResultType;
+
 // the common result type for a visitor called with each of the given element types:
 template<typename Visitor, typename... ElementTypes>
-struct ComputedResultType
+struct CommonVisitResultT
 {
 private:
     using ResultTypes = typelist<VisitElementResult<Visitor,ElementTypes>...>;
@@ -33,11 +37,9 @@ public:
 };
 
 template<typename Visitor, typename... ElementTypes>
-struct VisitResultT<typename ComputedResultType<Visitor,ElementTypes...>::type,
-                    Visitor,
-                    ElementTypes...>
+struct VisitResultT<ComputedResultType, Visitor, ElementTypes...>
 {
-    using type = typename ComputedResultType<Visitor, ElementTypes...>::type;
+    using type = typename CommonVisitResultT<Visitor, ElementTypes...>::type;
 };
 
 
@@ -50,13 +52,11 @@ struct stdVisitResultT
 };
 
 template<typename R, typename Visitor, typename... ElementTypes>
-using stdVisitResult = typename VisitResultT<R, Visitor, ElementTypes...>::type;
+using stdVisitResult = typename stdVisitResultT<R, Visitor, ElementTypes...>::type;
 
 // or using the standard library
 template<typename Visitor, typename... ElementTypes>
-struct stdVisitResultT<std::common_type_t<VisitElementResult<Visitor,ElementTypes>...>,
-                  Visitor,
-                  ElementTypes...>
+struct stdVisitResultT<ComputedResultType, Visitor, ElementTypes...>
 {
     using type = std::common_type_t<VisitElementResult<Visitor,ElementTypes>...>;
 };
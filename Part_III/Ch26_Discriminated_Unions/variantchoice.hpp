@@ -34,7 +34,7 @@ template<typename T, typename... Types>
 VariantChoice<T, Types...>::VariantChoice(T const& value)
 {
     // place value in buffer and set type discriminator:
-    new(getDerived().getRawBuffer()) T{value};
+    new(getDerived().template getRawBuffer<T>()) T{value};
     getDerived().setDiscriminator(Discriminator);
 }
 
@@ -42,7 +42,7 @@ template<typename T, typename... Types>
 VariantChoice<T, Types...>::VariantChoice(T&& value)
 {
     // place moved value in buffer and set type discriminator:
-    new(getDerived().getRawBuffer()) T{std::move(value)};
+    new(getDerived().template getRawBuffer<T>()) T{std::move(value)};
     getDerived().setDiscriminator(Discriminator);
 }
 /* --------------------------------------------------------------------------------------------- */
@@ -73,7 +73,7 @@ auto VariantChoice<T,Types...>::operator= (T const& value) -> Derived&
     else {
         // assign new value of different type:
         getDerived().destroy();     // try destroy() for all types
-        new(getDerived().getRawBuffer()) T{value};  // place new value
+        new(getDerived().template getRawBuffer<T>()) T{value};  // place new value
         getDerived().setDiscriminator(Discriminator);
     }
     return getDerived();
@@ -89,7 +89,7 @@ auto VariantChoice<T,Types...>::operator= (T&& value) -> Derived&
     else {
         // assign new value of different type:
         getDerived().destroy();
-        new(getDerived().getRawBuffer()) T{std::move(value)};
+        new(getDerived().template getRawBuffer<T>()) T{std::move(value)};
         getDerived().setDiscriminator(Discriminator);
     }
     return getDerived();
@@ -1,12 +1,17 @@
 #pragma once
 
+#include <cstddef>
 #include <new>  // for std::launder
+#include <type_traits>
 #include "typelist/typelist.hpp"
 #include "typelist/largest_type.hpp"
+#include "findindexof.hpp"
+#include "variant_niche.hpp"
 
 
+// the discriminator in a byte of its own, after the buffer
 template<typename... Types>
-class VariantStorage
+class SeparateDiscriminatorStorage
 {
 private:
     using largest_t = largest_type_t<typelist<Types...>>;
@@ -17,11 +22,201 @@ private:
 public:
     unsigned char getDiscriminator() const { return discriminator_; }
     void setDiscriminator(unsigned char d) { discriminator_ = d; }
-    void* getRawBuffer() { return buffer_; }
-    const void* getRawBuffer() const { return buffer_; }
 
+    template<typename T>
+    void* getRawBuffer() { return buffer_; }
     template<typename T>
     T* getBufferAs() { return std::launder(reinterpret_cast<T*>(buffer_)); }
     template<typename T>
     T const* getBufferAs() const { return std::launder(reinterpret_cast<T const*>(buffer_)); }
 };
+
+
+// the discriminator in the niche of the alternative Dataful (see variant_niche.hpp) - while
+// Dataful is held its niche bytes hold a valid value, otherwise the discriminator
+template<typename Dataful, typename... Types>
+class NicheDiscriminatorStorage
+{
+private:
+    using niche = niche_traits<Dataful>;
+    static constexpr unsigned char dataful_discriminator =
+        static_cast<unsigned char>(find_index_of_v<typelist<Types...>, Dataful> + 1);
+
+    alignas(Types...) unsigned char buffer_[sizeof(Dataful)];
+
+public:
+    NicheDiscriminatorStorage() noexcept { setDiscriminator(0); }
+
+    // (the invalid representations 0, 1, ... stand for the discriminators 0, 1, ... but that
+    // of Dataful, which is not needed)
+    unsigned char getDiscriminator() const
+    {
+        unsigned const k = niche::get(buffer_ + niche::offset);
+        if (k == niche::count) {
+            return dataful_discriminator;
+        }
+        return static_cast<unsigned char>(k < dataful_discriminator ? k : k + 1);
+    }
+    void setDiscriminator(unsigned char d)
+    {
+        // (Dataful, just constructed, holds a valid value already)
+        if (d != dataful_discriminator) {
+            niche::set(buffer_ + niche::offset, d < dataful_discriminator ? d : d - 1u);
+        }
+    }
+
+    template<typename T>
+    void* getRawBuffer() { return buffer_ + niche_placement<Dataful, T>(); }
+    template<typename T>
+    T* getBufferAs()
+    {
+        return std::launder(reinterpret_cast<T*>(buffer_ + niche_placement<Dataful, T>()));
+    }
+    template<typename T>
+    T const* getBufferAs() const
+    {
+        return std::launder(reinterpret_cast<T const*>(buffer_ + niche_placement<Dataful, T>()));
+    }
+};
+
+
+// the buffer and the discriminator, in the niche of an alternative when one of them has a
+// niche to spare
+template<typename... Types>
+using VariantLayout = std::conditional_t<
+    std::is_void_v<niche_alternative_t<Types...>>,
+    SeparateDiscriminatorStorage<Types...>,
+    NicheDiscriminatorStorage<niche_alternative_t<Types...>, Types...>>;
+
+
+// Are all of Types... copied, moved and destroyed trivially - then so is the Variant, the copy
+// of its buffer and discriminator being the copy of the alternative held
+template<typename... Types>
+constexpr inline bool trivial_alternatives_v =
+    ((std::is_trivially_copy_constructible_v<Types> && std::is_trivially_move_constructible_v<Types>
+      && std::is_trivially_copy_assignable_v<Types> && std::is_trivially_move_assignable_v<Types>
+      && std::is_trivially_destructible_v<Types>) && ...);
+
+
+// copy, move and destruction of the alternative held, through tables of functions indexed by
+// the discriminator - for alternatives of which some are not trivial
+template<typename... Types>
+class NontrivialVariantStorage : public VariantLayout<Types...>
+{
+private:
+    using Layout = VariantLayout<Types...>;
+    using Self = NontrivialVariantStorage;
+
+    template<typename T>
+    static void destroyAs(Self& self) { self.template getBufferAs<T>()->~T(); }
+    template<typename T>
+    static void copyAs(Self& self, Self const& source)
+    {
+        new(self.template getRawBuffer<T>()) T(*source.template getBufferAs<T>());
+    }
+    template<typename T>
+    static void moveAs(Self& self, Self& source)
+    {
+        new(self.template getRawBuffer<T>()) T(std::move(*source.template getBufferAs<T>()));
+    }
+    template<typename T>
+    static void copyAssignAs(Self& self, Self const& source)
+    {
+        *self.template getBufferAs<T>() = *source.template getBufferAs<T>();
+    }
+    template<typename T>
+    static void moveAssignAs(Self& self, Self& source)
+    {
+        *self.template getBufferAs<T>() = std::move(*source.template getBufferAs<T>());
+    }
+
+    // (entry d - 1 for the alternative with discriminator d)
+    static constexpr void (*destroyTable[])(Self&) = {&destroyAs<Types>...};
+    static constexpr void (*copyTable[])(Self&, Self const&) = {&copyAs<Types>...};
+    static constexpr void (*moveTable[])(Self&, Self&) = {&moveAs<Types>...};
+    static constexpr void (*copyAssignTable[])(Self&, Self const&) = {&copyAssignAs<Types>...};
+    static constexpr void (*moveAssignTable[])(Self&, Self&) = {&moveAssignAs<Types>...};
+
+public:
+    NontrivialVariantStorage() = default;
+
+    NontrivialVariantStorage(NontrivialVariantStorage const& source)
+        : Layout{}
+    {
+        if (unsigned char const d = source.getDiscriminator(); d != 0) {
+            copyTable[d - 1](*this, source);
+            this->setDiscriminator(d);
+        }
+    }
+
+    // (noexcept if all the moves are, so that std::vector moves rather than copies on growth)
+    NontrivialVariantStorage(NontrivialVariantStorage&& source)
+        noexcept((std::is_nothrow_move_constructible_v<Types> && ...))
+        : Layout{}
+    {
+        if (unsigned char const d = source.getDiscriminator(); d != 0) {
+            moveTable[d - 1](*this, source);
+            this->setDiscriminator(d);
+        }
+    }
+
+    // the alternative held assigned if source holds the same, otherwise destroyed first
+    // (the storage is left empty if the copy throws)
+    NontrivialVariantStorage& operator=(NontrivialVariantStorage const& source)
+    {
+        unsigned char const d = source.getDiscriminator();
+        if (d != 0 && d == this->getDiscriminator()) {
+            copyAssignTable[d - 1](*this, source);
+        }
+        else {
+            destroy();
+            if (d != 0) {
+                copyTable[d - 1](*this, source);
+                this->setDiscriminator(d);
+            }
+        }
+        return *this;
+    }
+
+    NontrivialVariantStorage& operator=(NontrivialVariantStorage&& source)
+        noexcept(((std::is_nothrow_move_constructible_v<Types>
+                   && std::is_nothrow_move_assignable_v<Types>) && ...))
+    {
+        unsigned char const d = source.getDiscriminator();
+        if (d != 0 && d == this->getDiscriminator()) {
+            moveAssignTable[d - 1](*this, source);
+        }
+        else {
+            destroy();
+            if (d != 0) {
+                moveTable[d - 1](*this, source);
+                this->setDiscriminator(d);
+            }
+        }
+        return *this;
+    }
+
+    ~NontrivialVariantStorage() { destroy(); }
+
+    // destroy the alternative held, if any
+    void destroy()
+    {
+        if (unsigned char const d = this->getDiscriminator(); d != 0) {
+            destroyTable[d - 1](*this);
+            this->setDiscriminator(0);
+        }
+    }
+};
+
+
+// the storage of Variant<Types...>: for trivial alternatives the layout alone - copied with a
+// memcpy, destroyed by doing nothing - otherwise one which copies and destroys the alternative
+// held; so that Variant<Types...> is trivially copyable and destructible if Types... all are,
+// and copies of it - in std::vector and std::sort, for example - are copies of its bytes
+template<typename... Types>
+class VariantStorage
+    : public std::conditional_t<trivial_alternatives_v<Types...>,
+                                VariantLayout<Types...>,
+                                NontrivialVariantStorage<Types...>>
+{
+};
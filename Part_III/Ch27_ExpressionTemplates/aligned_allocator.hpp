@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+
+// Allocator handing out memory aligned to Alignment bytes (by default a cache line, which is
+// also the width of an AVX-512 register), so that packet loads of an array never straddle
+// a cache line boundary at the start of the array.
+template<typename T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+    static_assert(Alignment >= alignof(T), "AlignedAllocator: alignment weaker than alignof(T)");
+    static_assert((Alignment & (Alignment - 1)) == 0, "AlignedAllocator: alignment must be a power of 2");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    // std::allocator_traits can not rebind an allocator with a non-type template parameter
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    constexpr AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    constexpr AlignedAllocator(AlignedAllocator<U, Alignment> const&) noexcept { }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t{Alignment});
+    }
+};
+
+template<typename T, typename U, std::size_t Alignment>
+constexpr bool operator==(AlignedAllocator<T, Alignment> const&,
+                          AlignedAllocator<U, Alignment> const&) noexcept
+{
+    return true;
+}
+
+template<typename T, typename U, std::size_t Alignment>
+constexpr bool operator!=(AlignedAllocator<T, Alignment> const&,
+                          AlignedAllocator<U, Alignment> const&) noexcept
+{
+    return false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include "aligned_allocator.hpp"
+
+// Minimal helpers shared by the *_bench.cpp programs.
+// Build with -DCMAKE_BUILD_TYPE=Release (and optionally -DENABLE_NATIVE_ARCH=ON)
+// for meaningful numbers - the default Debug build only checks that they run.
+
+// keep the compiler from optimizing away a result
+template<typename T>
+inline void do_not_optimize(T const& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// best-of-`reps` wall clock time of f() in nanoseconds
+template<typename F>
+double time_ns(F&& f, int reps = 5)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < reps; ++r) {
+        auto const start = std::chrono::steady_clock::now();
+        f();
+        auto const stop = std::chrono::steady_clock::now();
+        best = std::min(best,
+            std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    return best;
+}
+
+
+// number of allocations made through any CountingAllocator
+struct AllocationCounter
+{
+    static inline std::size_t count{0};
+};
+
+// AlignedAllocator which counts its allocations, to measure how many temporaries
+// an evaluation creates
+template<typename T>
+class CountingAllocator : public AlignedAllocator<T>
+{
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template<typename U>
+    struct rebind { using other = CountingAllocator<U>; };
+
+    constexpr CountingAllocator() noexcept = default;
+
+    template<typename U>
+    constexpr CountingAllocator(CountingAllocator<U> const&) noexcept { }
+
+    T* allocate(std::size_t n)
+    {
+        ++AllocationCounter::count;
+        return AlignedAllocator<T>::allocate(n);
+    }
+};
+
+template<typename T, typename U>
+constexpr bool operator==(CountingAllocator<T> const&, CountingAllocator<U> const&) noexcept
+{
+    return true;
+}
+
+template<typename T, typename U>
+constexpr bool operator!=(CountingAllocator<T> const&, CountingAllocator<U> const&) noexcept
+{
+    return false;
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "expr_capture.hpp"
+
+
+template<typename R, typename F>
+double max_error(Array<double,R> const& result, F reference)
+{
+    double err = 0.0;
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        err = std::max(err, std::abs(result[i] - reference(i)));
+    }
+    return err;
+}
+
+// an expression returned from a function - built from views, so nothing dangles
+auto axpy(double a, Array<double> const& x, Array<double> const& y)
+{
+    return a*view(x) + view(y);
+}
+
+using View = ArrayView<double const>;
+using Axpy = std::decay_t<decltype(axpy(2.0, std::declval<Array<double> const&>(),
+                                         std::declval<Array<double> const&>()).rep())>;
+static_assert(std::is_same_v<Axpy, A_FMA<double, A_Scalar<double>, View, View>>);
+static_assert(std::is_trivially_copyable_v<Axpy>);
+// a scalar and two pointer + size views
+static_assert(sizeof(Axpy) == 5 * sizeof(void*));
+// an ordinary expression refers to the arrays (and subexpressions)
+static_assert(!is_value_expr_v<A_Add<double, A_Mult<double, A_Scalar<double>, SArray<double>>,
+                                            SArray<double>>>);
+
+int main()
+{
+    std::size_t const n = 1003;
+    Array<double> x{n}, y{n}, r{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = std::sin(static_cast<double>(i));
+        y[i] = std::cos(static_cast<double>(i)) + 0.5;
+    }
+
+    // expressions kept in variables and evaluated later
+    auto const e = axpy(2.0, x, y);
+    auto const f = capture(where(x > y, sqrt(abs(x)), -y) * 3.0);
+    static_assert(std::is_trivially_copyable_v<std::decay_t<decltype(f.rep())>>);
+
+    r = e;
+    std::cout << "axpy:         " << max_error(r, [&](std::size_t i){
+        return 2.0*x[i] + y[i]; }) << '\n';
+    r = f;
+    std::cout << "captured:     " << max_error(r, [&](std::size_t i){
+        return 3.0 * (x[i] > y[i] ? std::sqrt(std::abs(x[i])) : -y[i]); }) << '\n';
+
+    // the views see the current elements of the arrays
+    x[0] = 100.0;
+    r = e;
+    std::cout << "x changed:    " << std::abs(r[0] - (200.0 + y[0])) << '\n';
+
+    // expressions in a container
+    std::vector<std::decay_t<decltype(e)>> exprs{axpy(1.0, x, y), axpy(-1.0, y, x)};
+    r = exprs[1];
+    std::cout << "in a vector:  " << max_error(r, [&](std::size_t i){
+        return -y[i] + x[i]; }) << '\n';
+
+    // a deferred assignment split between two threads
+    auto const task = deferred(r, 0.5*x + y*y);
+    std::thread worker{task, std::size_t{0}, n / 2};
+    task(n / 2, n);
+    worker.join();
+    std::cout << "deferred:     " << max_error(r, [&](std::size_t i){
+        return 0.5*x[i] + y[i]*y[i]; }) << '\n';
+}
@@ -0,0 +1,34 @@
+// (this demo always counts; elsewhere cmake -DENABLE_EXPR_COUNTERS=ON turns the counters on)
+#if !defined(EXPR_COUNTERS)
+#define EXPR_COUNTERS
+#endif
+#include <iostream>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "simple_ops.hpp"
+
+
+// The counters of expr_counters.hpp for x = 1.2*x + x*y, computed
+// - by an expression template - one evaluation, reading x twice and y once, no temporary
+// - by simple_ops.hpp - one temporary SArray per operator
+int main()
+{
+    std::size_t const n = 1000;
+    Array<double> x{n}, y{n};
+    SArray<double> sx{n}, sy{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = x[i] = 1.0 / static_cast<double>(i + 1);
+        sy[i] = y[i] = 0.5;
+    }
+    ExprCounters::reset();
+
+    for (int i = 0; i < 10; ++i) {
+        x = 1.2*x + x*y;
+        sx = 1.2*sx + sx*sy;
+    }
+    // an array assigned and copied
+    x = y;
+    SArray<double> copy{sx};
+
+    ExprCounters::dump_json(std::cout);
+}
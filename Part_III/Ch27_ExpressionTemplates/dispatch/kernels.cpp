@@ -0,0 +1,39 @@
+// The kernels of kernels.hpp, compiled once for each Isa level:
+//   -DEXPR_ISA=avx2 -march=x86-64-v3   defines isa_avx2::axpy, ...
+// (only kernels in here - see expr_dispatch.hpp - and no counters)
+#undef EXPR_COUNTERS
+#include "kernels.hpp"
+#include "../expr_array.hpp"
+#include "../expr_ops.hpp"
+#include "../expr_reduce.hpp"
+#include "../expr_capture.hpp"
+
+namespace EXPR_ISA_NAMESPACE {
+
+EXPR_KERNEL void axpy(double a, double const* x, double const* y, double* z, std::size_t n)
+{
+    auto out = view(z, n);
+    out = a*view(x, n) + view(y, n);
+}
+
+EXPR_KERNEL void polynomial(double const* x, double* z, std::size_t n)
+{
+    // (Horner's scheme - every step is a fused multiply-add)
+    auto const v = view(x, n);
+    auto out = view(z, n);
+    out = ((((((0.5*v + 0.25)*v - 1.0)*v + 2.0)*v - 0.125)*v + 3.0)*v - 1.5)*v + 0.75;
+}
+
+EXPR_KERNEL void leaky_relu(float a, float const* x, float* z, std::size_t n)
+{
+    auto const v = view(x, n);
+    auto out = view(z, n);
+    out = where(v > 0.0f, v, a*v);
+}
+
+EXPR_KERNEL double dot(double const* x, double const* y, std::size_t n)
+{
+    return ::dot(view(x, n), view(y, n));
+}
+
+}
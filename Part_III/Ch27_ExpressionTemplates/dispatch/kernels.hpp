@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include "../expr_dispatch.hpp"
+
+// The kernels of dispatch_bench.cpp: kernels.cpp is compiled for every Isa level
+// (see CMakeLists.txt), here the copies are declared and collected in dispatch tables.
+
+#define DISPATCH_KERNELS                                                                        \
+    /* z = a*x + y */                                                                          \
+    void axpy(double a, double const* x, double const* y, double* z, std::size_t n);           \
+    /* z = p(x), a polynomial of degree 7 */                                                   \
+    void polynomial(double const* x, double* z, std::size_t n);                                \
+    /* z = x > 0 ? x : a*x */                                                                  \
+    void leaky_relu(float a, float const* x, float* z, std::size_t n);                         \
+    /* the inner product of x and y */                                                         \
+    double dot(double const* x, double const* y, std::size_t n);
+
+namespace isa_baseline { DISPATCH_KERNELS }
+#if defined(__x86_64__)
+namespace isa_sse42 { DISPATCH_KERNELS }
+namespace isa_avx2 { DISPATCH_KERNELS }
+namespace isa_avx512 { DISPATCH_KERNELS }
+#endif
+
+// (not in the kernel files themselves)
+#if !defined(EXPR_ISA)
+
+#if defined(__x86_64__)
+#define DISPATCH_TABLE(name) \
+    Dispatch<decltype(isa_baseline::name)> \
+        name{isa_baseline::name, isa_sse42::name, isa_avx2::name, isa_avx512::name}
+#else
+#define DISPATCH_TABLE(name) \
+    Dispatch<decltype(isa_baseline::name)> name{isa_baseline::name}
+#endif
+
+namespace kernels {
+inline DISPATCH_TABLE(axpy);
+inline DISPATCH_TABLE(polynomial);
+inline DISPATCH_TABLE(leaky_relu);
+inline DISPATCH_TABLE(dot);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include "dispatch/kernels.hpp"
+#include "bench_util.hpp"
+
+
+// The kernels of dispatch/kernels.cpp, by the instruction set level they were compiled for.
+// Every level the CPU supports is timed (ns/elem), and its results are compared with the
+// baseline copy; the program itself is compiled for baseline x86-64, unless
+// ENABLE_NATIVE_ARCH is set. At start-up the dispatch tables log the level they selected -
+// set EXPR_ISA=avx2 (or sse4.2, baseline) to select a lower one.
+//
+// usage: dispatch_bench [elements]
+
+// call(copy, n) runs a copy of the kernel, check() sums up its result
+template<typename F, typename Call, typename Check>
+void run(char const* name, Dispatch<F> const& kernel, std::size_t n, Call call, Check check)
+{
+    std::cout << std::left << std::setw(12) << name << std::right;
+    double const reference = (call(kernel[Isa::baseline], n), check());
+    bool same = true;
+    for (std::size_t level = 0; level < isa_count; ++level) {
+        Isa const isa = static_cast<Isa>(level);
+        F* const copy = kernel[isa];
+        if (copy == nullptr || isa > detect_isa()) {
+            std::cout << std::setw(10) << "-";
+            continue;
+        }
+        auto const ns = time_ns([&]{ call(copy, n); }, 20);
+        // (the levels may round differently - fused multiply-adds)
+        same = same && std::abs(check() - reference) <= 1e-9 * std::max(1.0, std::abs(reference));
+        std::cout << std::setw(10) << std::setprecision(3) << ns / static_cast<double>(n);
+    }
+    std::cout << "   selected: " << isa_name(kernel.isa()) << (same ? "" : " (results differ)")
+              << '\n';
+}
+
+// (the arrays of the kernels)
+std::vector<double> x, y, z;
+std::vector<float> xf, zf;
+double result = 0.0;
+
+double sum_z() { double s = 0.0; for (double v : z) s += v; return s; }
+double sum_zf() { double s = 0.0; for (float v : zf) s += static_cast<double>(v); return s; }
+double dot_result() { return result; }
+
+int main(int argc, char* argv[])
+{
+    std::size_t const n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    x.resize(n); y.resize(n); z.resize(n); xf.resize(n); zf.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = std::sin(static_cast<double>(i));
+        y[i] = 1.0 / static_cast<double>(i + 1);
+        xf[i] = static_cast<float>(x[i]);
+    }
+
+    std::cout << "elements: " << n << ", ns/elem by level\n" << std::setw(12) << "";
+    for (std::size_t level = 0; level < isa_count; ++level) {
+        std::cout << std::setw(10) << isa_name(static_cast<Isa>(level));
+    }
+    std::cout << '\n';
+
+    run("axpy", kernels::axpy, n,
+        [](auto* f, std::size_t m){ f(2.5, x.data(), y.data(), z.data(), m); }, sum_z);
+    run("polynomial", kernels::polynomial, n,
+        [](auto* f, std::size_t m){ f(x.data(), z.data(), m); }, sum_z);
+    run("leaky_relu", kernels::leaky_relu, n,
+        [](auto* f, std::size_t m){ f(0.1f, xf.data(), zf.data(), m); }, sum_zf);
+    run("dot", kernels::dot, n,
+        [](auto* f, std::size_t m){ result = f(x.data(), y.data(), m); do_not_optimize(result); },
+        dot_result);
+
+    // through the dispatch table
+    kernels::axpy(2.5, x.data(), y.data(), z.data(), n);
+    std::cout << "dispatched axpy: z[1] = " << z[1] << '\n';
+}
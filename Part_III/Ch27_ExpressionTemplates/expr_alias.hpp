@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include "simple_array.hpp"
+#include "expr_eval.hpp"
+#include "expr_stream.hpp"
+
+// Aliasing analysis of an assignment dst = src, before it is evaluated.
+// The memory of every leaf of src which has data() - or storage(), for arrays which keep
+// their elements in another form, like Float16Array - is compared with that of dst - one
+// comparison per leaf, whatever the number of elements:
+// - none of them overlaps dst: the loop stores through a __restrict pointer (eval_restrict)
+// - a leaf is dst itself, read only at the element being written (x = 2.0*x + y):
+//   evaluated in place, by the ordinary loops
+// - otherwise (x = shift(x, -1), or a view of a part of x): src is evaluated into a scratch
+//   array first, which is then copied to dst
+// A scatter x[y] = src writes anywhere in x, so src reading x at all takes the scratch array.
+// Of a destination whose memory is unknown src is assumed to read it: evaluated in place if
+// all of src is elementwise, through the scratch array otherwise (and for any scatter).
+// The nodes that read their operand at other indices are listed by is_elementwise below.
+
+enum class Aliasing { none, in_place, overlap };
+
+// the stronger of two results
+constexpr Aliasing combine(Aliasing a, Aliasing b)
+{
+    return a < b ? b : a;
+}
+
+
+// Does element idx of a node read only element idx of its operands
+/* --------------------------------------------------------------------------------------------- */
+template<typename E>
+struct is_elementwise : std::true_type { };
+
+template<typename T, typename OP, typename Boundary>
+struct is_elementwise<A_Shift<T,OP,Boundary>> : std::false_type { };
+
+template<typename T, typename OP>
+struct is_elementwise<A_Slice<T,OP>> : std::false_type { };
+
+template<typename T, typename OP, typename Boundary, std::size_t N>
+struct is_elementwise<A_Stencil<T,OP,Boundary,N>> : std::false_type { };
+
+template<typename T, typename OP, typename From, typename To>
+struct is_elementwise<A_Relayout<T,OP,From,To>> : std::false_type { };
+
+template<typename E>
+constexpr inline bool is_elementwise_v = is_elementwise<E>::value;
+
+// are all nodes of the expression elementwise (subscripts aside - see has_subscript)
+template<typename E>
+constexpr bool all_elementwise()
+{
+    bool elementwise = is_elementwise_v<E>;
+    if constexpr (has_condition_operand<E>::value) {
+        elementwise = elementwise
+                      && all_elementwise<std::decay_t<decltype(std::declval<E const&>().condition())>>();
+    }
+    if constexpr (has_first_operand<E>::value) {
+        elementwise = elementwise
+                      && all_elementwise<std::decay_t<decltype(std::declval<E const&>().first())>>();
+    }
+    if constexpr (has_second_operand<E>::value) {
+        elementwise = elementwise
+                      && all_elementwise<std::decay_t<decltype(std::declval<E const&>().second())>>();
+    }
+    if constexpr (has_third_operand<E>::value) {
+        elementwise = elementwise
+                      && all_elementwise<std::decay_t<decltype(std::declval<E const&>().third())>>();
+    }
+    return elementwise;
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// the memory of an array: the bytes [first, last), of elements of element_size bytes
+struct AliasTarget
+{
+    char const* first;
+    char const* last;
+    std::size_t element_size;
+};
+
+// Does the array expose the memory of its elements: data(), or storage() for elements
+// kept in another form
+template<typename E, typename = std::void_t<>>
+struct has_storage : std::false_type { };
+
+template<typename E>
+struct has_storage<E, std::void_t<decltype(std::declval<E const&>().storage())>>
+    : std::true_type { };
+
+template<typename E>
+constexpr inline bool has_alias_range_v = has_contiguous_data_v<E> || has_storage<E>::value;
+
+template<typename V>
+AliasTarget memory_range(V const* p, std::size_t n)
+{
+    auto const first = reinterpret_cast<char const*>(p);
+    return AliasTarget{first, first + n * sizeof(V), sizeof(V)};
+}
+
+// the memory of the first n elements of an array
+template<typename E>
+AliasTarget alias_range(E const& array, std::size_t n)
+{
+    if constexpr (has_contiguous_data_v<E>) {
+        return memory_range(array.data(), n);
+    }
+    else {
+        return memory_range(array.storage(), n);
+    }
+}
+
+// a leaf - elementwise: it is read only at the index being written
+template<typename E>
+Aliasing leaf_aliasing(E const& leaf, AliasTarget const& dst, bool elementwise)
+{
+    if constexpr (has_alias_range_v<E>) {
+        AliasTarget const range = alias_range(leaf, leaf.size());
+        if (range.last <= dst.first || dst.last <= range.first || range.first == range.last) {
+            return Aliasing::none;
+        }
+        bool const same = range.first == dst.first && range.last == dst.last
+                          && range.element_size == dst.element_size;
+        return same && elementwise ? Aliasing::in_place : Aliasing::overlap;
+    }
+    else {
+        return Aliasing::none;
+    }
+}
+
+template<typename E>
+Aliasing expr_aliasing(E const& e, AliasTarget const& dst, bool elementwise = true)
+{
+    constexpr bool node = has_condition_operand<E>::value || has_first_operand<E>::value;
+    if constexpr (!node) {
+        return leaf_aliasing(e, dst, elementwise);
+    }
+    else {
+        bool const operands_elementwise = elementwise && is_elementwise_v<E>;
+        Aliasing result = Aliasing::none;
+        if constexpr (has_condition_operand<E>::value) {
+            result = combine(result, expr_aliasing(e.condition(), dst, operands_elementwise));
+        }
+        if constexpr (has_first_operand<E>::value) {
+            result = combine(result, expr_aliasing(e.first(), dst, operands_elementwise));
+        }
+        if constexpr (has_second_operand<E>::value) {
+            result = combine(result, expr_aliasing(e.second(), dst, operands_elementwise));
+        }
+        if constexpr (has_third_operand<E>::value) {
+            result = combine(result, expr_aliasing(e.third(), dst, operands_elementwise));
+        }
+        return result;
+    }
+}
+
+// x[y] reads x anywhere, y at the index being written
+template<typename T, typename A1, typename A2>
+Aliasing expr_aliasing(A_Subscript<T,A1,A2> const& e, AliasTarget const& dst,
+                       bool elementwise = true)
+{
+    return combine(expr_aliasing(e.array(), dst, false),
+                   expr_aliasing(e.indices(), dst, elementwise));
+}
+
+
+// the loops of eval_restrict, over the tree it prepared (see packet_loop)
+template<typename T, typename E>
+void restrict_loop(T* __restrict out, E const& e, std::size_t first, std::size_t last)
+{
+    std::size_t idx = first;
+    if constexpr (has_packet_v<T> && is_packet_accessible_v<E,T>) {
+        constexpr std::size_t width = Packet<T>::size;
+        for (; last - idx >= width; idx += width) {
+            Packet<T>::store(out + idx, e.load_packet(idx));
+        }
+    }
+    for (; idx < last; ++idx) {
+        out[idx] = e[idx];
+    }
+}
+
+// The loops of eval_packet / eval_scalar, for a destination which no leaf of src reads:
+// the stores go through a restrict-qualified pointer, and both loops run over the local
+// copy of the tree (see local_rep) - of its root node at least, for a tree with leaves that
+// cannot be viewed (not of the leaf of x = y, which is an array) - with repeated operands
+// evaluated once (see with_shared).
+template<typename T, typename Src>
+void eval_restrict(T* __restrict out, Src const& src, std::size_t first, std::size_t last)
+{
+    constexpr bool node = has_condition_operand<Src>::value || has_first_operand<Src>::value;
+    using Local = decltype(local_rep(src));
+    using Copy = std::conditional_t<node && std::is_reference_v<Local>, Src, Local>;
+    Copy const local = local_rep(src);
+    with_shared(local, [&](auto const& e) {
+        restrict_loop<T>(out, e, first, last);
+    });
+}
+
+
+// the aliasing of dst = src for [0, n)
+template<typename Dst, typename Src>
+Aliasing assignment_aliasing(Dst const& dst, Src const& src, std::size_t n)
+{
+    if constexpr (has_alias_range_v<Dst>) {
+        return expr_aliasing(src, alias_range(dst, n));
+    }
+    else if constexpr (is_subscript_v<Dst>) {
+        auto const& array = dst.array();
+        if constexpr (has_alias_range_v<std::decay_t<decltype(array)>>) {
+            // (any element of x may be written, so no leaf is read at the element written)
+            return expr_aliasing(src, alias_range(array, array.size()), false);
+        }
+        else {
+            return Aliasing::overlap;
+        }
+    }
+    else {
+        return all_elementwise<Src>() && !has_subscript_v<Src> ? Aliasing::in_place
+                                                                : Aliasing::overlap;
+    }
+}
+
+// dst = src for [0, n), with the loop chosen by the aliasing of dst and src
+// (evaluated in one go or in chunks - see evaluate_all)
+template<typename T, typename Dst, typename Src>
+void evaluate_assignment(Dst& dst, Src const& src, std::size_t n)
+{
+    if constexpr (is_sparse_rep_v<Dst>) {
+        // (built apart from dst, whatever src reads - see eval_sparse)
+        evaluate_all<T>(dst, src, n);
+    }
+    else {
+        Aliasing const aliasing = assignment_aliasing(dst, src, n);
+        if (aliasing == Aliasing::overlap) {
+            SArray<T> scratch{n, uninitialized};
+            evaluate_all<T>(scratch, src, n);
+            evaluate_all<T>(dst, scratch, n);
+            return;
+        }
+        // (the gather, sparse, streamed and conversion loops, and the unrolled assignment of
+        // small fixed arrays, are kept)
+        if constexpr (has_contiguous_data_v<Dst>) {
+            using V = std::remove_pointer_t<decltype(dst.data())>;
+            constexpr bool restrict_loop = std::is_same_v<typename Src::value_type, T>
+                                           && std::is_same_v<V, T>
+                                           && !is_subscript_v<Src> && !has_subscript_v<Src>
+                                           && !has_sparse_support_v<Src>
+                                           && !is_streamed_v<Dst> && !has_streamed_leaf<Src>()
+                                           && (static_size_v<Dst> == 0
+                                               || static_size_v<Dst> > unroll_limit);
+            if constexpr (restrict_loop) {
+                if (aliasing == Aliasing::none) {
+                    eval_restrict<T>(dst.data(), src, 0, n);
+                    return;
+                }
+            }
+        }
+        evaluate_all<T>(dst, src, n);
+    }
+}
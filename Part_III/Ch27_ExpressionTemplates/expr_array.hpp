@@ -2,8 +2,13 @@
 
 #include <cstddef>
 #include <cassert>
+#include <utility>
 #include "simple_array.hpp"
 #include "expr_types.hpp"
+#include "expr_eval.hpp"
+#include "expr_stream.hpp"
+#include "expr_alias.hpp"
+#include "expr_counters.hpp"
 
 
 template<typename T, typename Rep = SArray<T>>
@@ -17,27 +22,39 @@ public:
     explicit Array(std::size_t s)
         : expr_rep_{s} { }
 
+    // create array with initial size, leaving trivial elements uninitialized
+    Array(std::size_t s, uninitialized_t)
+        : expr_rep_{s, uninitialized} { }
+
     // create array from possible representation
     Array(Rep const& rb)
         : expr_rep_{rb} { }
 
+    // ...or take it over, e.g. a representation which can not be copied
+    Array(Rep&& rb)
+        : expr_rep_{std::move(rb)} { }
+
     // assignment operator for same type
     Array& operator= (Array const& b) {
         assert(size() == b.size());
-        for (std::size_t idx = 0; idx < b.size(); ++idx) {
-            expr_rep_[idx] = b[idx];
-        }
+        EXPR_COUNT_EVALUATION(T, b.rep(), b.size());
+        evaluate_assignment<T>(expr_rep_, b.rep(), b.size());
         return *this;
     }
 
     // assignment operator for arrays of different type
     // We must take into account that the "other array" is really built on an expression template.
+    // If every node of the expression supports packet access the tree is evaluated a SIMD
+    // register at a time (see expr_eval.hpp), otherwise one element at a time.
+    // Arrays which are streamed from files are assigned a chunk at a time (see expr_stream.hpp).
+    // Unless the expression reads the array itself, the loop stores through a restrict
+    // pointer; if it reads it at other indices, through a scratch array (see expr_alias.hpp).
+    // With -DEXPR_COUNTERS the assignment is counted (see expr_counters.hpp).
     template<typename T2, typename Rep2>
     Array& operator= (Array<T2, Rep2> const& b) {
         assert(size() == b.size());
-        for (std::size_t idx = 0; idx < b.size(); ++idx) {
-            expr_rep_[idx] = b[idx];
-        }
+        EXPR_COUNT_EVALUATION(T, b.rep(), b.size());
+        evaluate_assignment<T>(expr_rep_, b.rep(), b.size());
         return *this;
     }
 
@@ -54,7 +71,8 @@ public:
         return expr_rep_[idx];
     }
 
-    T& operator[] (std::size_t idx) {
+    // (a reference, or a proxy reference for representations which convert their elements)
+    decltype(auto) operator[] (std::size_t idx) {
         assert(idx<size());
         return expr_rep_[idx];
     }
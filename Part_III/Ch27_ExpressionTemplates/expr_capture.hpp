@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <type_traits>
+#include "expr_array.hpp"
+#include "expr_types.hpp"
+#include "expr_eval.hpp"
+#include "expr_view.hpp"
+
+// Expressions which can be stored.
+// The nodes of an ordinary expression refer to their operands, some of which are temporaries
+// (the nodes of subexpressions), so the expression has to be evaluated within the
+// full-expression creating it:
+//   auto e = 2.0*x + y;        // e refers to the destroyed temporary node 2.0*x
+// Built from views of the arrays instead, every node holds its operands by value (see
+// is_value_expr in expr_traits.hpp), and the expression is a small trivially copyable
+// object - it can be kept in a variable, returned from a function or handed to another
+// thread, and it never allocates:
+//   auto e = 2.0*view(x) + view(y);
+//   auto f = capture(2.0*x + y);   // the same, from an ordinary expression
+// The views still refer to the elements of the arrays, which have to outlive the expression.
+
+
+// read-only view of the elements of an array
+template<typename T, typename Rep>
+Array<T, ArrayView<T const>> view(Array<T,Rep> const& a)
+{
+    static_assert(has_contiguous_data_v<Rep>, "view: the array does not store its elements");
+    return Array<T, ArrayView<T const>>{ArrayView<T const>{a.rep().data(), a.size()}};
+}
+
+// view of n elements at data - read-only for `T const`
+template<typename T>
+Array<std::remove_const_t<T>, ArrayView<T>> view(T* data, std::size_t n)
+{
+    return Array<std::remove_const_t<T>, ArrayView<T>>{ArrayView<T>{data, n}};
+}
+
+
+// the expression e, with views of its arrays
+template<typename T, typename Rep>
+auto capture(Array<T,Rep> const& e)
+{
+    using Captured = decltype(capture_rep(e.rep()));
+    static_assert(is_value_expr_v<Captured>);
+    return Array<T, Captured>{capture_rep(e.rep())};
+}
+
+
+// A deferred assignment dst = src: a trivially copyable function object, which evaluates
+// the assignment when it is called - as a whole, or for the index range [first, last).
+// It can be handed to another thread or stored in a queue of work, without copying arrays.
+// Called as a whole it checks the aliasing of dst and src as Array assignment does
+// (expr_alias.hpp), so deferred(x, shift(x, -1)) goes through a scratch array; a range has
+// to be written without reading dst at other elements (x = 2.0*x + y may be split,
+// x = shift(x, -1) may not).
+template<typename T, typename Src>
+class Deferred
+{
+public:
+    Deferred(ArrayView<T> dst, Src const& src)
+        : dst_{dst}, src_{src}
+        {
+            assert(src.size() == 0 || src.size() == dst.size());
+        }
+
+    std::size_t size() const { return dst_.size(); }
+
+    void operator()() const {
+        ArrayView<T> dst{dst_};
+        evaluate_assignment<T>(dst, src_, size());
+    }
+
+    void operator()(std::size_t first, std::size_t last) const {
+        assert(assignment_aliasing(dst_, src_, size()) != Aliasing::overlap);
+        ArrayView<T> dst{dst_};
+        evaluate<T>(dst, src_, first, last);
+    }
+
+private:
+    ArrayView<T> dst_;
+    Src src_;
+};
+
+template<typename T, typename Rep, typename T2, typename Rep2>
+auto deferred(Array<T,Rep>& dst, Array<T2,Rep2> const& src)
+{
+    static_assert(has_contiguous_data_v<Rep>, "deferred: the array does not store its elements");
+    auto const captured = capture(src);
+    using Src = std::decay_t<decltype(captured.rep())>;
+    return Deferred<T, Src>{ArrayView<T>{dst.rep().data(), dst.size()}, captured.rep()};
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+// Counters of the work done by the arrays, to find out in a running program how much memory
+// the assignments of expressions move and how many temporary arrays are created.
+// They are compiled in with -DEXPR_COUNTERS (cmake -DENABLE_EXPR_COUNTERS=ON); otherwise the
+// EXPR_COUNT_* hooks below expand to nothing, and this header includes nothing.
+//
+// Counted, with relaxed atomic increments:
+// - per expression type (the type of the right-hand side of Array::operator=): evaluations,
+//   elements, bytes written to the destination and, for every leaf, bytes read from it -
+//   size * sizeof(element), as the expression sees it, not as the caches do
+// - per SArray type: heap allocations and copies (copy construction and copy assignment),
+//   with their bytes
+// ExprCounters::dump_json(std::cout) writes them, ExprCounters::reset() clears them.
+
+#if defined(EXPR_COUNTERS)
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// the name of type T, as the compiler spells it in __PRETTY_FUNCTION__
+template<typename T>
+std::string type_name()
+{
+    // "... [with T = name; ...]" (GCC), "... [T = name]" (Clang)
+    std::string_view const function = __PRETTY_FUNCTION__;
+    auto const first = function.find("T = ") + 4;
+    auto const last = std::min(function.find(';', first), function.rfind(']'));
+    return std::string{function.substr(first, last - first)};
+}
+
+class ExprCounters
+{
+public:
+    using counter = std::atomic<std::uint64_t>;
+
+    struct Leaf
+    {
+        std::string type{};
+        counter bytes_read{0};
+    };
+
+    struct Expression
+    {
+        counter evaluations{0};
+        counter elements{0};
+        counter bytes_written{0};
+        std::deque<Leaf> leaves{};
+    };
+
+    struct Storage
+    {
+        counter allocations{0};
+        counter bytes_allocated{0};
+        counter copies{0};
+        counter bytes_copied{0};
+    };
+
+    // dst = src, n elements of type T
+    template<typename T, typename Src>
+    static void evaluation(Src const& src, std::size_t n) {
+        static Expression& counters = expression<Src>(src);
+        counters.evaluations.fetch_add(1, std::memory_order_relaxed);
+        counters.elements.fetch_add(n, std::memory_order_relaxed);
+        counters.bytes_written.fetch_add(n * sizeof(T), std::memory_order_relaxed);
+        auto leaf = counters.leaves.begin();
+        for_each_leaf(src, [&](auto const& e) {
+            // (scalars have size 0)
+            using E = std::decay_t<decltype(e)>;
+            (leaf++)->bytes_read.fetch_add(e.size() == 0 ? 0 : n * sizeof(typename E::value_type),
+                                           std::memory_order_relaxed);
+        });
+    }
+
+    template<typename Array>
+    static void allocation(std::size_t bytes) {
+        static Storage& counters = storage<Array>();
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    template<typename Array>
+    static void copy(std::size_t bytes) {
+        static Storage& counters = storage<Array>();
+        counters.copies.fetch_add(1, std::memory_order_relaxed);
+        counters.bytes_copied.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    // all counters, as a JSON object
+    static void dump_json(std::ostream& out) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        out << "{\n  \"expressions\": [";
+        char const* separator = "\n";
+        for (auto const& [type, e] : r.expressions) {
+            out << separator << "    {\"type\": ";
+            write_string(out, type);
+            out << ", \"evaluations\": " << e.evaluations << ", \"elements\": " << e.elements
+                << ", \"bytes_written\": " << e.bytes_written << ",\n     \"leaves\": [";
+            char const* leaf_separator = "";
+            for (Leaf const& leaf : e.leaves) {
+                out << leaf_separator << "{\"type\": ";
+                write_string(out, leaf.type);
+                out << ", \"bytes_read\": " << leaf.bytes_read << '}';
+                leaf_separator = ", ";
+            }
+            out << "]}";
+            separator = ",\n";
+        }
+        out << "\n  ],\n  \"arrays\": [";
+        separator = "\n";
+        for (auto const& [type, s] : r.storage) {
+            out << separator << "    {\"type\": ";
+            write_string(out, type);
+            out << ", \"allocations\": " << s.allocations
+                << ", \"bytes_allocated\": " << s.bytes_allocated << ", \"copies\": " << s.copies
+                << ", \"bytes_copied\": " << s.bytes_copied << '}';
+            separator = ",\n";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    // set all counters to zero
+    static void reset() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        for (auto& [type, e] : r.expressions) {
+            e.evaluations = 0;
+            e.elements = 0;
+            e.bytes_written = 0;
+            for (Leaf& leaf : e.leaves) {
+                leaf.bytes_read = 0;
+            }
+        }
+        for (auto& [type, s] : r.storage) {
+            s.allocations = 0;
+            s.bytes_allocated = 0;
+            s.copies = 0;
+            s.bytes_copied = 0;
+        }
+    }
+
+private:
+    // (the counters are never removed, so references to them stay valid)
+    struct Registry
+    {
+        std::mutex mutex{};
+        std::map<std::string, Expression> expressions{};
+        std::map<std::string, Storage> storage{};
+    };
+
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    template<typename Src>
+    static Expression& expression(Src const& src) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        auto const [it, inserted] = r.expressions.try_emplace(type_name<Src>());
+        if (inserted) {
+            for_each_leaf(src, [&](auto const& e) {
+                it->second.leaves.emplace_back().type = type_name<std::decay_t<decltype(e)>>();
+            });
+        }
+        return it->second;
+    }
+
+    template<typename Array>
+    static Storage& storage() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        return r.storage[type_name<Array>()];
+    }
+
+    static void write_string(std::ostream& out, std::string const& s) {
+        out << '"';
+        for (char const c : s) {
+            if (c == '"' || c == '\\') {
+                out << '\\';
+            }
+            out << c;
+        }
+        out << '"';
+    }
+};
+
+// (for_each_leaf, of expr_stream.hpp, is found when the hook is instantiated)
+#define EXPR_COUNT_EVALUATION(T, src, n) ExprCounters::evaluation<T>(src, n)
+#define EXPR_COUNT_ALLOCATION(Array, bytes) ExprCounters::allocation<Array>(bytes)
+#define EXPR_COUNT_COPY(Array, bytes) ExprCounters::copy<Array>(bytes)
+
+#else
+
+#define EXPR_COUNT_EVALUATION(T, src, n)
+#define EXPR_COUNT_ALLOCATION(Array, bytes)
+#define EXPR_COUNT_COPY(Array, bytes)
+
+#endif
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+#include <cassert>
+#include <initializer_list>
+#include <utility>
+
+// Selection of expression kernels by the instruction set of the CPU, at run time.
+// Packet<T> (expr_packet.hpp) is fixed when a translation unit is compiled: a program built
+// for baseline x86-64 never uses AVX2 or AVX-512, one built with -march=native does not run
+// on older machines. Instead, the hot assignments of a program are written once as kernels -
+// functions of pointers, which evaluate an expression of array views:
+//
+//   // kernels.cpp - compiled once per Isa level, see dispatch/ and CMakeLists.txt
+//   namespace EXPR_ISA_NAMESPACE {
+//   EXPR_KERNEL void axpy(double a, double const* x, double const* y, double* z, std::size_t n)
+//   {
+//       auto out = view(z, n);
+//       out = a*view(x, n) + view(y, n);
+//   }
+//   }
+//
+// The kernel file is compiled with -DEXPR_ISA=<level> and the -march of the level, so every
+// copy evaluates with its own Packet<T> and lives in its own namespace (isa_avx2::axpy, ...).
+// A Dispatch table of the copies calls the best one the CPU supports; the CPU is examined once,
+// when the program starts, and the choice is logged to stderr.
+//
+// EXPR_KERNEL inlines the whole evaluation into the kernel. A kernel file must define nothing
+// but kernels - no dispatch tables, no static objects (nor <iostream>): a function left out of
+// line would be compiled for the wider instruction set, and the linker could pick that copy for
+// the rest of the program; a static initializer would run on every CPU.
+
+enum class Isa { baseline, sse42, avx2, avx512 };
+
+constexpr inline std::size_t isa_count = 4;
+
+inline char const* isa_name(Isa isa)
+{
+    switch (isa) {
+        case Isa::sse42: return "sse4.2";
+        case Isa::avx2: return "avx2";
+        case Isa::avx512: return "avx512";
+        default: return "baseline";
+    }
+}
+
+#define EXPR_ISA_CONCAT_(a, b) a ## b
+#define EXPR_ISA_CONCAT(a, b) EXPR_ISA_CONCAT_(a, b)
+// the namespace of the kernels of the level the file is compiled for
+#define EXPR_ISA_NAMESPACE EXPR_ISA_CONCAT(isa_, EXPR_ISA)
+
+#if defined(__GNUC__)
+#define EXPR_KERNEL __attribute__((flatten))
+#else
+#define EXPR_KERNEL
+#endif
+
+
+// the highest level the CPU supports - the x86-64 micro-architecture levels
+// (x86-64-v2, -v3, -v4), reduced to the features the kernels can make use of
+inline Isa detect_isa()
+{
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+        && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+        return Isa::avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+        && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("f16c")) {
+        return Isa::avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+        return Isa::sse42;
+    }
+#endif
+    return Isa::baseline;
+}
+
+// the level kernels are selected for: the detected one, unless the environment variable
+// EXPR_ISA names a lower one (baseline, sse4.2, avx2) - to run the paths of older CPUs
+inline Isa selected_isa()
+{
+    static Isa const selected = []{
+        Isa const detected = detect_isa();
+        Isa isa = detected;
+        if (char const* const limit = std::getenv("EXPR_ISA")) {
+            for (std::size_t level = 0; level < isa_count; ++level) {
+                Isa const candidate = static_cast<Isa>(level);
+                if (std::strcmp(limit, isa_name(candidate)) == 0 && candidate < detected) {
+                    isa = candidate;
+                }
+            }
+        }
+        std::fprintf(stderr, "expr_dispatch: cpu supports %s, expression kernels use %s\n",
+                     isa_name(detected), isa_name(isa));
+        return isa;
+    }();
+    return selected;
+}
+
+
+// The copies of a kernel, one per Isa level (nullptr for levels which are not built),
+// and the one selected for this CPU. Dispatch tables are meant to be defined at namespace scope,
+// so the selection happens during start-up, and a call is one indirect call.
+template<typename F>
+class Dispatch
+{
+public:
+    Dispatch(std::initializer_list<F*> kernels)
+        : kernels_{}, isa_{Isa::baseline}, selected_{nullptr}
+        {
+            assert(kernels.size() <= isa_count);
+            std::size_t level = 0;
+            for (F* const kernel : kernels) {
+                kernels_[level++] = kernel;
+            }
+            assert(kernels_[0] != nullptr);  // (the baseline always runs)
+            for (level = 0; level <= static_cast<std::size_t>(selected_isa()); ++level) {
+                if (kernels_[level] != nullptr) {
+                    isa_ = static_cast<Isa>(level);
+                    selected_ = kernels_[level];
+                }
+            }
+        }
+
+    // the level of the selected copy
+    Isa isa() const { return isa_; }
+
+    // the copy for a level, nullptr if it is not built - it must only be called on CPUs
+    // which support the level
+    F* operator[](Isa isa) const {
+        return kernels_[static_cast<std::size_t>(isa)];
+    }
+
+    template<typename... Args>
+    decltype(auto) operator()(Args&&... args) const {
+        return selected_(std::forward<Args>(args)...);
+    }
+
+private:
+    std::array<F*, isa_count> kernels_;
+    Isa isa_;
+    F* selected_;
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "expr_packet.hpp"
+#include "expr_gather.hpp"
+#include "expr_view.hpp"
+
+// Evaluation loops used by Array assignment.
+// Every loop evaluates the index range [first, last) of the expression `src` into `dst`,
+// so that callers may evaluate a whole array or only a chunk of it.
+
+// the reference implementation - one element at a time through operator[]
+template<typename Dst, typename Src>
+void eval_scalar(Dst& dst, Src const& src, std::size_t first, std::size_t last)
+{
+    for (std::size_t idx = first; idx < last; ++idx) {
+        dst[idx] = src[idx];
+    }
+}
+
+// the loop of eval_packet, over the tree it prepared (in a function of its own, so that the
+// bounds are locals of the loop rather than captures of a lambda, which it would reload)
+template<typename T, typename Dst, typename E>
+void packet_loop(Dst& dst, E const& e, std::size_t first, std::size_t last)
+{
+    constexpr std::size_t width = Packet<T>::size;
+    std::size_t idx = first;
+    if constexpr (has_contiguous_data_v<Dst>) {
+        T* const out = dst.data();
+        for (; last - idx >= width; idx += width) {
+            Packet<T>::store(out + idx, e.load_packet(idx));
+        }
+    }
+    else {
+        for (; last - idx >= width; idx += width) {
+            dst.store_packet(idx, e.load_packet(idx));
+        }
+    }
+    eval_scalar(dst, e, idx, last);
+}
+
+// Packet<T>::size elements at a time through load_packet()/store_packet(),
+// followed by a scalar loop for the remaining tail elements.
+// The loop runs over a local copy of the tree (see local_rep), and stores through the data
+// pointer of a contiguous destination, so that no pointer or scalar is reloaded per packet;
+// repeated operands (x*x) are evaluated once (see with_shared).
+template<typename T, typename Dst, typename Src>
+void eval_packet(Dst& dst, Src const& src, std::size_t first, std::size_t last)
+{
+    static_assert(is_packet_evaluable_v<T,Dst,Src>,
+                  "eval_packet: expression does not support packet access");
+    with_shared(local_rep(src), [&](auto const& e) {
+        packet_loop<T>(dst, e, first, last);
+    });
+}
+
+// Arrays with a compile-time size of at most unroll_limit elements are assigned by
+// a fully unrolled sequence of element assignments, without any loop
+// (the idea of DotProduct<T,N> in Ch23_Metaprogramming/dot_product.cpp).
+constexpr inline std::size_t unroll_limit = 16;
+
+template<typename Dst, typename Src, std::size_t... Idx>
+void eval_unrolled(Dst& dst, Src const& src, std::index_sequence<Idx...>)
+{
+    ((dst[Idx] = src[Idx]), ...);
+}
+
+// Assignment of an expression of another value type S than the destination's T,
+// e.g. of a double expression to a float array: every element is converted when it is
+// stored. A contiguous destination is written a packet of S at a time, if the target can
+// convert such a packet to T (see PacketConvert).
+template<typename T, typename Dst, typename Src>
+void eval_convert(Dst& dst, Src const& src, std::size_t first, std::size_t last)
+{
+    using S = typename Src::value_type;
+    std::size_t idx = first;
+    if constexpr (has_packet_v<S> && has_packet_convert_v<S,T> && is_packet_accessible_v<Src,S>
+                  && has_contiguous_data_v<Dst> && std::is_same_v<typename Dst::value_type, T>) {
+        constexpr std::size_t width = Packet<S>::size;
+        T* const out = dst.data();
+        for (; last - idx >= width; idx += width) {
+            PacketConvert<S,T>::store(out + idx, src.load_packet(idx));
+        }
+    }
+    for (; idx < last; ++idx) {
+        dst[idx] = static_cast<T>(src[idx]);
+    }
+}
+
+// select the best loop at compile time
+template<typename T, typename Dst, typename Src>
+void evaluate(Dst& dst, Src const& src, std::size_t first, std::size_t last)
+{
+    constexpr bool same_type = std::is_same_v<typename Src::value_type, T>;
+    constexpr std::size_t fixed = static_size_v<Dst>;
+    if constexpr (same_type && fixed != 0 && fixed <= unroll_limit) {
+        if (first == 0 && last == fixed) {
+            eval_unrolled(dst, src, std::make_index_sequence<fixed>{});
+            return;
+        }
+    }
+
+    if constexpr (is_subscript_v<Dst>) {
+        eval_scatter(dst, src, first, last, GatherPolicy{});
+    }
+    else if constexpr (!same_type) {
+        eval_convert<T>(dst, src, first, last);
+    }
+    else if constexpr (is_subscript_v<Src>) {
+        eval_gather<T>(dst, src, first, last, GatherPolicy{});
+    }
+    else if constexpr (has_subscript_v<Src>) {
+        eval_indirect<T>(dst, src, first, last, GatherPolicy{}.prefetch_distance, last);
+    }
+    else if constexpr (is_packet_evaluable_v<T,Dst,Src>) {
+        eval_packet<T>(dst, src, first, last);
+    }
+    else {
+        eval_scalar(dst, src, first, last);
+    }
+}
@@ -1,6 +1,18 @@
 #pragma once
 
+#include <cstddef>
 
 template<typename> class A_Scalar;
 template<typename,typename,typename> class A_Mult;
-template<typename,typename,typename> class A_Add;
\ No newline at end of file
+template<typename,typename,typename> class A_Add;
+template<typename,typename,typename,typename> class A_FMA;
+template<typename,typename,typename,typename> class A_Binary;
+template<typename,typename,typename> class A_Unary;
+template<typename,typename,typename,typename> class A_Compare;
+template<typename,typename,typename,typename> class A_Where;
+template<typename,typename> class A_Convert;
+template<typename,typename,typename> class A_Shift;
+template<typename,typename> class A_Slice;
+template<typename,typename,typename,std::size_t> class A_Stencil;
+template<typename,typename,typename,typename> class A_Relayout;
+template<typename> class ArrayView;
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include "expr_types.hpp"
+#include "expr_packet.hpp"
+
+// Evaluation loops for expressions involving A_Subscript, i.e. gathers (r = x[y]) and
+// scatters (x[y] = e). Reading x[y[i]] for random y is dominated by cache misses, so:
+// - the index array can be read ahead and the element needed `prefetch_distance` iterations
+//   later prefetched, so that its cache miss overlaps with the current work
+// - the index range of a scatter is processed in blocks; a block whose indices are contiguous
+//   is written as a plain loop, a block writing a narrow ascending window is left to the
+//   hardware prefetcher
+// - where the target has gather instructions, A_Subscript::load_packet() uses them
+//   (see PacketGather in expr_packet.hpp)
+// A gather is the packet loop whatever its indices: copying contiguous blocks with memcpy
+// cost more than checking the indices saved (see gather_bench).
+
+
+// tuning knobs of the gather/scatter loops
+// Prefetching is off by default: an out-of-order core already keeps the misses of many
+// independent x[y[i]] in flight, and no distance measured beat the plain loop (gather_bench
+// times a range of them). It can pay off on cores with a shorter window.
+struct GatherPolicy
+{
+    std::size_t prefetch_distance{0};   // in elements, 0: no software prefetching
+    std::size_t block{256};             // granularity of the index run detection (scatter)
+};
+
+
+// Traits
+/* --------------------------------------------------------------------------------------------- */
+template<typename E>
+struct is_subscript : std::false_type { };
+
+template<typename T, typename A1, typename A2>
+struct is_subscript<A_Subscript<T,A1,A2>> : std::true_type { };
+
+template<typename E>
+constexpr inline bool is_subscript_v = is_subscript<E>::value;
+
+// does an expression tree contain a subscript anywhere
+template<typename E>
+struct has_subscript : is_subscript<E> { };
+
+template<typename T, typename OP1, typename OP2>
+struct has_subscript<A_Add<T,OP1,OP2>> : std::disjunction<has_subscript<OP1>,
+                                                          has_subscript<OP2>> { };
+
+template<typename T, typename OP1, typename OP2>
+struct has_subscript<A_Mult<T,OP1,OP2>> : std::disjunction<has_subscript<OP1>,
+                                                           has_subscript<OP2>> { };
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+struct has_subscript<A_FMA<T,OP1,OP2,OP3>> : std::disjunction<has_subscript<OP1>,
+                                                              has_subscript<OP2>,
+                                                              has_subscript<OP3>> { };
+
+template<typename T, typename OP1, typename OP2, typename Op>
+struct has_subscript<A_Binary<T,OP1,OP2,Op>> : std::disjunction<has_subscript<OP1>,
+                                                                has_subscript<OP2>> { };
+
+template<typename T, typename OP, typename Op>
+struct has_subscript<A_Unary<T,OP,Op>> : has_subscript<OP> { };
+
+template<typename T, typename OP1, typename OP2, typename Cmp>
+struct has_subscript<A_Compare<T,OP1,OP2,Cmp>> : std::disjunction<has_subscript<OP1>,
+                                                                  has_subscript<OP2>> { };
+
+template<typename T, typename M, typename OP1, typename OP2>
+struct has_subscript<A_Where<T,M,OP1,OP2>> : std::disjunction<has_subscript<M>,
+                                                              has_subscript<OP1>,
+                                                              has_subscript<OP2>> { };
+
+template<typename T, typename OP>
+struct has_subscript<A_Convert<T,OP>> : has_subscript<OP> { };
+
+template<typename T, typename OP, typename Boundary>
+struct has_subscript<A_Shift<T,OP,Boundary>> : has_subscript<OP> { };
+
+template<typename T, typename OP>
+struct has_subscript<A_Slice<T,OP>> : has_subscript<OP> { };
+
+template<typename T, typename OP, typename Boundary, std::size_t N>
+struct has_subscript<A_Stencil<T,OP,Boundary,N>> : has_subscript<OP> { };
+
+template<typename E>
+constexpr inline bool has_subscript_v = has_subscript<E>::value;
+/* --------------------------------------------------------------------------------------------- */
+
+
+// Prefetching
+/* --------------------------------------------------------------------------------------------- */
+inline void prefetch_read(void const* p)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(p, 0, 3);
+#else
+    (void)p;
+#endif
+}
+
+inline void prefetch_write(void const* p)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(p, 1, 3);
+#else
+    (void)p;
+#endif
+}
+
+// prefetch whatever element idx of the expression will read through subscripts
+// leaves are read sequentially - the hardware prefetcher takes care of them
+template<typename E>
+void expr_prefetch(E const&, std::size_t)
+{
+}
+
+template<typename T, typename OP1, typename OP2>
+void expr_prefetch(A_Add<T,OP1,OP2> const& e, std::size_t idx)
+{
+    expr_prefetch(e.first(), idx);
+    expr_prefetch(e.second(), idx);
+}
+
+template<typename T, typename OP1, typename OP2>
+void expr_prefetch(A_Mult<T,OP1,OP2> const& e, std::size_t idx)
+{
+    expr_prefetch(e.first(), idx);
+    expr_prefetch(e.second(), idx);
+}
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+void expr_prefetch(A_FMA<T,OP1,OP2,OP3> const& e, std::size_t idx)
+{
+    expr_prefetch(e.first(), idx);
+    expr_prefetch(e.second(), idx);
+    expr_prefetch(e.third(), idx);
+}
+
+template<typename T, typename OP1, typename OP2, typename Op>
+void expr_prefetch(A_Binary<T,OP1,OP2,Op> const& e, std::size_t idx)
+{
+    expr_prefetch(e.first(), idx);
+    expr_prefetch(e.second(), idx);
+}
+
+template<typename T, typename OP, typename Op>
+void expr_prefetch(A_Unary<T,OP,Op> const& e, std::size_t idx)
+{
+    expr_prefetch(e.first(), idx);
+}
+
+template<typename T, typename OP1, typename OP2, typename Cmp>
+void expr_prefetch(A_Compare<T,OP1,OP2,Cmp> const& e, std::size_t idx)
+{
+    expr_prefetch(e.first(), idx);
+    expr_prefetch(e.second(), idx);
+}
+
+template<typename T, typename M, typename OP1, typename OP2>
+void expr_prefetch(A_Where<T,M,OP1,OP2> const& e, std::size_t idx)
+{
+    expr_prefetch(e.condition(), idx);
+    expr_prefetch(e.first(), idx);
+    expr_prefetch(e.second(), idx);
+}
+
+template<typename T, typename OP>
+void expr_prefetch(A_Convert<T,OP> const& e, std::size_t idx)
+{
+    expr_prefetch(e.first(), idx);
+}
+
+// the nodes of expr_stencil.hpp forward to the element of the operand they read
+// (for a stencil its last tap: the earlier ones were prefetched for the previous elements)
+template<typename T, typename OP, typename Boundary>
+void expr_prefetch(A_Shift<T,OP,Boundary> const& e, std::size_t idx)
+{
+    std::ptrdiff_t const j = static_cast<std::ptrdiff_t>(idx) + e.offset();
+    if (j >= 0 && static_cast<std::size_t>(j) < e.first().size()) {
+        expr_prefetch(e.first(), static_cast<std::size_t>(j));
+    }
+}
+
+template<typename T, typename OP>
+void expr_prefetch(A_Slice<T,OP> const& e, std::size_t idx)
+{
+    std::ptrdiff_t const j = static_cast<std::ptrdiff_t>(e.start())
+                             + static_cast<std::ptrdiff_t>(idx) * e.step();
+    if (j >= 0 && static_cast<std::size_t>(j) < e.first().size()) {
+        expr_prefetch(e.first(), static_cast<std::size_t>(j));
+    }
+}
+
+template<typename T, typename OP, typename Boundary, std::size_t N>
+void expr_prefetch(A_Stencil<T,OP,Boundary,N> const& e, std::size_t idx)
+{
+    std::ptrdiff_t const j = static_cast<std::ptrdiff_t>(idx) + e.origin()
+                             + static_cast<std::ptrdiff_t>(N - 1);
+    if (j >= 0 && static_cast<std::size_t>(j) < e.first().size()) {
+        expr_prefetch(e.first(), static_cast<std::size_t>(j));
+    }
+}
+
+template<typename T, typename A1, typename A2>
+void expr_prefetch(A_Subscript<T,A1,A2> const& e, std::size_t idx)
+{
+    if constexpr (has_contiguous_data_v<A1>) {
+        prefetch_read(e.array().data() + static_cast<std::size_t>(e.indices()[idx]));
+    }
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// Index run detection
+/* --------------------------------------------------------------------------------------------- */
+// contiguous: y[i+1] == y[i] + 1 throughout the block
+// local:      the block reads a narrow, ascending window of the array (e.g. sorted indices),
+//             which the hardware prefetcher already handles well
+// random:     anything else
+enum class IndexRun { contiguous, local, random };
+
+// classify the indices [first, last)
+// The endpoints decide in O(1); only a block which may be contiguous is checked element by
+// element (without early exit, so that the loop vectorizes).
+template<typename Indices>
+IndexRun classify_indices(Indices const& indices, std::size_t first, std::size_t last)
+{
+    using index_type = std::make_signed_t<std::common_type_t<
+                            std::decay_t<decltype(indices[first])>, std::ptrdiff_t>>;
+    auto const count = static_cast<index_type>(last - first);
+    auto const span = static_cast<index_type>(indices[last - 1])
+                      - static_cast<index_type>(indices[first]);
+
+    if (span == count - 1) {
+        std::size_t gaps = 0;
+        for (std::size_t i = first + 1; i < last; ++i) {
+            gaps += (indices[i] != indices[i - 1] + 1);
+        }
+        if (gaps == 0) {
+            return IndexRun::contiguous;
+        }
+    }
+    // at most ~ one cache line of doubles per index
+    return (span >= 0 && span < 8 * count) ? IndexRun::local : IndexRun::random;
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// Evaluation loops
+/* --------------------------------------------------------------------------------------------- */
+// evaluate [first, last), prefetching `distance` elements ahead as long as that element
+// is below prefetch_end (pass a distance or prefetch_end of 0 to disable prefetching)
+template<typename T, typename Dst, typename Src>
+void eval_indirect(Dst& dst, Src const& src, std::size_t first, std::size_t last,
+                   std::size_t distance, std::size_t prefetch_end)
+{
+    if (distance == 0) {
+        prefetch_end = 0;
+    }
+    std::size_t idx = first;
+    if constexpr (is_packet_evaluable_v<T,Dst,Src>) {
+        constexpr std::size_t width = Packet<T>::size;
+        for (; last - idx >= width; idx += width) {
+            std::size_t const ahead = std::min(idx + distance + width, prefetch_end);
+            for (std::size_t k = idx + distance; k < ahead; ++k) {
+                expr_prefetch(src, k);
+            }
+            dst.store_packet(idx, src.load_packet(idx));
+        }
+    }
+    for (; idx < last; ++idx) {
+        if (idx + distance < prefetch_end) {
+            expr_prefetch(src, idx + distance);
+        }
+        dst[idx] = src[idx];
+    }
+}
+
+// r = x[y] - a bare gather
+template<typename T, typename Dst, typename A1, typename A2>
+void eval_gather(Dst& dst, A_Subscript<T,A1,A2> const& src,
+                 std::size_t first, std::size_t last, GatherPolicy const& policy)
+{
+    eval_indirect<T>(dst, src, first, last, policy.prefetch_distance, last);
+}
+
+// x[y] = e - a scatter
+template<typename T, typename A1, typename A2, typename Src>
+void eval_scatter(A_Subscript<T,A1,A2>& dst, Src const& src,
+                  std::size_t first, std::size_t last, GatherPolicy const& policy)
+{
+    A1& array = dst.array();
+    A2 const& indices = dst.indices();
+    std::size_t const distance = policy.prefetch_distance;
+
+    for (std::size_t block_first = first; block_first < last; ) {
+        std::size_t const block_last = std::min(last, block_first + policy.block);
+        IndexRun const run = classify_indices(indices, block_first, block_last);
+
+        if (run == IndexRun::contiguous) {
+            auto const start = static_cast<std::size_t>(indices[block_first]);
+            for (std::size_t idx = block_first; idx < block_last; ++idx) {
+                array[start + (idx - block_first)] = src[idx];
+            }
+        }
+        else {
+            bool const prefetch = run == IndexRun::random && distance > 0;
+            for (std::size_t idx = block_first; idx < block_last; ++idx) {
+                if (prefetch && idx + distance < last) {
+                    if constexpr (has_contiguous_data_v<A1>) {
+                        prefetch_write(array.data()
+                                       + static_cast<std::size_t>(indices[idx + distance]));
+                    }
+                    expr_prefetch(src, idx + distance);
+                }
+                array[static_cast<std::size_t>(indices[idx])] = src[idx];
+            }
+        }
+        block_first = block_last;
+    }
+}
+/* --------------------------------------------------------------------------------------------- */
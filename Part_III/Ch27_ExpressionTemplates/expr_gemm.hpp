@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include "simple_array.hpp"
+#include "expr_packet.hpp"
+#include "expr_matrix.hpp"
+
+// The matrix product. A*B only records its operands (like the elementwise nodes, it refers
+// to them, so it has to be used within the full-expression creating it); the product is
+// computed when it is assigned to a matrix:
+//   C = A*B;   C = transpose(A)*(B + D);
+//
+// The computation follows the blocked algorithm of GotoBLAS / BLIS:
+// - B is processed in panels of kc x nc elements, A in blocks of mc x kc elements,
+//   sized so that the block of A stays in the L2 cache and a sliver of the B panel in L1
+// - the blocks are packed into contiguous buffers, in the order the micro-kernel reads them
+//   (this also turns any layout, transposition or elementwise expression of the operands
+//   into the same sequential reads)
+// - the micro-kernel computes an mr x nr tile of C in registers: mr x (nr / packet width)
+//   packet accumulators, updated by fused multiply-adds with one broadcast element of A
+//   and one row of nr elements of B for each step along k.
+
+
+// register tile of the micro-kernel
+template<typename T>
+struct GemmKernel
+{
+    static constexpr std::size_t width = Packet<T>::size;
+    static constexpr std::size_t mr = 6;
+    static constexpr std::size_t nr = width > 1 ? 2 * width : 4;
+    static constexpr std::size_t packets = nr / width;
+};
+
+// cache blocking (mc and nc are rounded down to multiples of mr and nr)
+struct GemmBlocking
+{
+    std::size_t mc{96};     // rows of the packed block of A   - mc x kc in L2
+    std::size_t kc{256};    // depth of the packed blocks      - kc x nr of B in L1
+    std::size_t nc{2048};   // columns of the packed panel of B
+};
+
+
+// class for objects that represent the matrix product a*b
+template<typename MA, typename MB>
+class MatrixProduct
+{
+private:
+    MA const& a_;
+    MB const& b_;
+
+public:
+    using value_type = typename MA::value_type;
+
+    MatrixProduct(MA const& a, MB const& b)
+        : a_{a}, b_{b}
+        {
+            assert(a.cols() == b.rows());
+        }
+
+    std::size_t rows() const { return a_.rows(); }
+    std::size_t cols() const { return b_.cols(); }
+
+    MA const& lhs() const { return a_; }
+    MB const& rhs() const { return b_; }
+};
+
+template<typename T, typename R1, typename L1, typename R2, typename L2>
+MatrixProduct<Matrix<T,R1,L1>, Matrix<T,R2,L2>>
+operator*(Matrix<T,R1,L1> const& a, Matrix<T,R2,L2> const& b)
+{
+    return MatrixProduct<Matrix<T,R1,L1>, Matrix<T,R2,L2>>{a, b};
+}
+
+
+// packing
+/* --------------------------------------------------------------------------------------------- */
+// rows [i0, i0 + m) and columns [p0, p0 + k) of a, as consecutive panels of mr rows,
+// each stored column by column; rows beyond m are padded with zeros
+template<typename T, typename MA>
+void gemm_pack_a(MA const& a, std::size_t i0, std::size_t m, std::size_t p0, std::size_t k,
+                 T* buffer)
+{
+    constexpr std::size_t mr = GemmKernel<T>::mr;
+    for (std::size_t ir = 0; ir < m; ir += mr) {
+        std::size_t const rows = std::min(mr, m - ir);
+        for (std::size_t p = 0; p < k; ++p) {
+            for (std::size_t r = 0; r < rows; ++r) {
+                buffer[r] = a(i0 + ir + r, p0 + p);
+            }
+            for (std::size_t r = rows; r < mr; ++r) {
+                buffer[r] = T{};
+            }
+            buffer += mr;
+        }
+    }
+}
+
+// rows [p0, p0 + k) and columns [j0, j0 + n) of b, as consecutive panels of nr columns,
+// each stored row by row; columns beyond n are padded with zeros
+template<typename T, typename MB>
+void gemm_pack_b(MB const& b, std::size_t p0, std::size_t k, std::size_t j0, std::size_t n,
+                 T* buffer)
+{
+    constexpr std::size_t nr = GemmKernel<T>::nr;
+    for (std::size_t jr = 0; jr < n; jr += nr) {
+        std::size_t const cols = std::min(nr, n - jr);
+        for (std::size_t p = 0; p < k; ++p) {
+            for (std::size_t c = 0; c < cols; ++c) {
+                buffer[c] = b(p0 + p, j0 + jr + c);
+            }
+            for (std::size_t c = cols; c < nr; ++c) {
+                buffer[c] = T{};
+            }
+            buffer += nr;
+        }
+    }
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// tile = a * b for an mr x k panel of A and a k x nr panel of B (both packed),
+// tile is mr x nr, row by row
+template<typename T>
+void gemm_micro_kernel(std::size_t k, T const* a, T const* b, T* tile)
+{
+    using K = GemmKernel<T>;
+    using P = Packet<T>;
+
+    typename P::type acc[K::mr][K::packets];
+    for (auto& row : acc) {
+        for (auto& v : row) {
+            v = P::broadcast(T{});
+        }
+    }
+    for (std::size_t p = 0; p < k; ++p, a += K::mr, b += K::nr) {
+        typename P::type bp[K::packets];
+        for (std::size_t j = 0; j < K::packets; ++j) {
+            bp[j] = P::load(b + j * K::width);
+        }
+        for (std::size_t r = 0; r < K::mr; ++r) {
+            auto const ar = P::broadcast(a[r]);
+            for (std::size_t j = 0; j < K::packets; ++j) {
+                acc[r][j] = P::fmadd(ar, bp[j], acc[r][j]);
+            }
+        }
+    }
+    for (std::size_t r = 0; r < K::mr; ++r) {
+        for (std::size_t j = 0; j < K::packets; ++j) {
+            P::store(tile + r * K::nr + j * K::width, acc[r][j]);
+        }
+    }
+}
+
+// does matrix m read the storage of c - through any leaf of its expression (the product
+// reads whole rows and columns of its operands while c is written, so any overlap counts;
+// c of unknown memory is assumed to be read)
+template<typename T, typename RC, typename LC, typename M>
+bool gemm_aliases(Matrix<T,RC,LC> const& c, M const& m)
+{
+    if constexpr (has_alias_range_v<RC>) {
+        return c.size() != 0
+               && expr_aliasing(m.rep(), alias_range(c.rep(), c.size())) != Aliasing::none;
+    }
+    else {
+        return true;
+    }
+}
+
+// c = a * b
+// Operands reading c - c itself, a transposed view of it, or expressions involving it - are
+// detected, and the product is computed into a temporary.
+template<typename T, typename RC, typename LC, typename MA, typename MB>
+void gemm(Matrix<T,RC,LC>& c, MA const& a, MB const& b, GemmBlocking const& blocking = GemmBlocking{})
+{
+    using K = GemmKernel<T>;
+    std::size_t const m = a.rows();
+    std::size_t const k = a.cols();
+    std::size_t const n = b.cols();
+    assert(b.rows() == k && c.rows() == m && c.cols() == n);
+
+    if (gemm_aliases(c, a) || gemm_aliases(c, b)) {
+        Matrix<T, SArray<T>, LC> result{m, n, uninitialized};
+        gemm(result, a, b, blocking);
+        c = result;
+        return;
+    }
+    if (k == 0) {
+        c = Matrix<T, A_Scalar<T>, LC>{A_Scalar<T>{T{}}, m, n};
+        return;
+    }
+
+    std::size_t const mc = std::max(K::mr, blocking.mc / K::mr * K::mr);
+    std::size_t const nc = std::max(K::nr, blocking.nc / K::nr * K::nr);
+    std::size_t const kc = std::max<std::size_t>(1, blocking.kc);
+    SArray<T> a_pack{mc * kc, uninitialized};
+    SArray<T> b_pack{kc * std::min(nc, (n + K::nr - 1) / K::nr * K::nr), uninitialized};
+    alignas(64) T tile[K::mr * K::nr];
+
+    for (std::size_t jc = 0; jc < n; jc += nc) {
+        std::size_t const nb = std::min(nc, n - jc);
+        for (std::size_t pc = 0; pc < k; pc += kc) {
+            std::size_t const kb = std::min(kc, k - pc);
+            gemm_pack_b(b, pc, kb, jc, nb, b_pack.data());
+
+            for (std::size_t ic = 0; ic < m; ic += mc) {
+                std::size_t const mb = std::min(mc, m - ic);
+                gemm_pack_a(a, ic, mb, pc, kb, a_pack.data());
+
+                for (std::size_t jr = 0; jr < nb; jr += K::nr) {
+                    std::size_t const cols = std::min(K::nr, nb - jr);
+                    for (std::size_t ir = 0; ir < mb; ir += K::mr) {
+                        std::size_t const rows = std::min(K::mr, mb - ir);
+                        gemm_micro_kernel(kb, a_pack.data() + ir * kb, b_pack.data() + jr * kb,
+                                          tile);
+                        // the first block along k initializes c, the others accumulate
+                        for (std::size_t r = 0; r < rows; ++r) {
+                            for (std::size_t col = 0; col < cols; ++col) {
+                                T& dst = c(ic + ir + r, jc + jr + col);
+                                dst = pc == 0 ? tile[r * K::nr + col]
+                                              : dst + tile[r * K::nr + col];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <type_traits>
+#include "simple_array.hpp"
+#include "expr_types.hpp"
+#include "expr_eval.hpp"
+#include "expr_alias.hpp"
+
+// Matrices on top of the one-dimensional expression templates.
+// A Matrix is a Rep - storage or an expression tree of the usual nodes - which is indexed
+// linearly in the storage order of its Layout, plus the number of rows and columns.
+// Elementwise operations on matrices of the same layout are therefore the very same
+// A_Add / A_Mult / ... trees as for Array, evaluated by the same (packet) loops.
+//
+// transpose() is free: the transpose of a row-major matrix is the column-major matrix
+// of the same elements, so it only relabels the layout and swaps rows and columns.
+// Operands of different layouts are reconciled by the A_Relayout node, which maps the
+// linear index of one layout to the other (element by element, no packet access) - and so
+// reads its operand at other indices: a matrix assigned an expression which reads it
+// through a relayout, d = d + transpose(d), is evaluated through a scratch matrix.
+//
+// The matrix product A*B is not elementwise - see expr_gemm.hpp.
+
+
+// storage orders
+struct RowMajor
+{
+    static std::size_t index(std::size_t i, std::size_t j, std::size_t, std::size_t cols) {
+        return i * cols + j;
+    }
+    static std::size_t row(std::size_t idx, std::size_t, std::size_t cols) { return idx / cols; }
+    static std::size_t col(std::size_t idx, std::size_t, std::size_t cols) { return idx % cols; }
+};
+
+struct ColMajor
+{
+    static std::size_t index(std::size_t i, std::size_t j, std::size_t rows, std::size_t) {
+        return j * rows + i;
+    }
+    static std::size_t row(std::size_t idx, std::size_t rows, std::size_t) { return idx % rows; }
+    static std::size_t col(std::size_t idx, std::size_t rows, std::size_t) { return idx / rows; }
+};
+
+// the layout of the transpose
+template<typename Layout>
+struct transposed_layout;
+
+template<>
+struct transposed_layout<RowMajor> { using type = ColMajor; };
+
+template<>
+struct transposed_layout<ColMajor> { using type = RowMajor; };
+
+template<typename Layout>
+using transposed_layout_t = typename transposed_layout<Layout>::type;
+
+
+// class for objects that present the matrix expression OP, stored in layout From, in the
+// linear order of layout To. rows and cols are those of the matrix, not of the storage.
+template<typename T, typename OP, typename From, typename To>
+class A_Relayout
+{
+private:
+    typename A_Traits<OP>::ExprRef op;
+    std::size_t rows_;
+    std::size_t cols_;
+
+public:
+    using value_type = T;
+    static constexpr bool packet_access = false;
+
+    A_Relayout(OP const& a, std::size_t rows, std::size_t cols)
+        : op{a}, rows_{rows}, cols_{cols} { }
+
+    decltype(auto) operator[](std::size_t idx) const {
+        return op[From::index(To::row(idx, rows_, cols_), To::col(idx, rows_, cols_),
+                              rows_, cols_)];
+    }
+
+    OP const& first() const { return op; }
+
+    std::size_t size() const { return op.size(); }
+};
+
+// relayout nodes are created as temporaries inside the operators, so nodes refer to them
+// by value (they are small)
+template<typename T, typename OP, typename From, typename To>
+class A_Traits<A_Relayout<T,OP,From,To>> {
+public:
+    using ExprRef = A_Relayout<T,OP,From,To>;
+};
+
+
+// the matrix product, see expr_gemm.hpp
+template<typename MA, typename MB>
+class MatrixProduct;
+
+
+template<typename T, typename Rep = SArray<T>, typename Layout = RowMajor>
+class Matrix
+{
+private:
+    Rep expr_rep_;
+    std::size_t rows_;
+    std::size_t cols_;
+
+public:
+    using value_type = T;
+    using layout = Layout;
+
+    // create a rows x cols matrix
+    Matrix(std::size_t rows, std::size_t cols)
+        : expr_rep_{rows * cols}, rows_{rows}, cols_{cols} { }
+
+    Matrix(std::size_t rows, std::size_t cols, uninitialized_t)
+        : expr_rep_{rows * cols, uninitialized}, rows_{rows}, cols_{cols} { }
+
+    // create matrix from possible representation
+    Matrix(Rep const& rb, std::size_t rows, std::size_t cols)
+        : expr_rep_{rb}, rows_{rows}, cols_{cols}
+        {
+            assert(expr_rep_.size() == 0 || expr_rep_.size() == rows * cols);
+        }
+
+    Matrix(Matrix const&) = default;
+
+    Matrix& operator=(Matrix const& b) {
+        assert(rows() == b.rows() && cols() == b.cols());
+        evaluate_assignment<T>(expr_rep_, b.rep(), size());
+        return *this;
+    }
+
+    // assignment of a matrix expression - linear in the storage order if the layouts
+    // match, through A_Relayout otherwise; like that of an Array, through a scratch matrix
+    // if the expression reads the matrix at other elements (d = d + transpose(d),
+    // see expr_alias.hpp)
+    template<typename T2, typename Rep2, typename Layout2>
+    Matrix& operator=(Matrix<T2,Rep2,Layout2> const& b) {
+        assert(rows() == b.rows() && cols() == b.cols());
+        if constexpr (std::is_same_v<Layout, Layout2>) {
+            evaluate_assignment<T>(expr_rep_, b.rep(), size());
+        }
+        else {
+            evaluate_assignment<T>(expr_rep_,
+                                   A_Relayout<T2,Rep2,Layout2,Layout>{b.rep(), rows_, cols_},
+                                   size());
+        }
+        return *this;
+    }
+
+    // create matrix from a matrix product, i.e. compute the product (see expr_gemm.hpp)
+    template<typename MA, typename MB>
+    Matrix(MatrixProduct<MA,MB> const& p)
+        : Matrix(p.rows(), p.cols(), uninitialized)
+        {
+            gemm(*this, p.lhs(), p.rhs());
+        }
+
+    template<typename MA, typename MB>
+    Matrix& operator=(MatrixProduct<MA,MB> const& p) {
+        assert(rows() == p.rows() && cols() == p.cols());
+        gemm(*this, p.lhs(), p.rhs());
+        return *this;
+    }
+
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::size_t size() const { return rows_ * cols_; }
+
+    // element in row i, column j
+    decltype(auto) operator()(std::size_t i, std::size_t j) const {
+        assert(i < rows_ && j < cols_);
+        return expr_rep_[Layout::index(i, j, rows_, cols_)];
+    }
+
+    T& operator()(std::size_t i, std::size_t j) {
+        assert(i < rows_ && j < cols_);
+        return expr_rep_[Layout::index(i, j, rows_, cols_)];
+    }
+
+    Rep const& rep() const { return expr_rep_; }
+    Rep& rep() { return expr_rep_; }
+};
+
+
+// the elements of matrix b in the storage order of layout L:
+// b's representation itself, or a relayout node
+template<typename L, typename T, typename R, typename LB>
+decltype(auto) in_layout(Matrix<T,R,LB> const& b)
+{
+    if constexpr (std::is_same_v<L, LB>) {
+        return (b.rep());
+    }
+    else {
+        return A_Relayout<T,R,LB,L>{b.rep(), b.rows(), b.cols()};
+    }
+}
+
+template<typename L, typename M>
+using in_layout_t = std::decay_t<decltype(in_layout<L>(std::declval<M const&>()))>;
+
+
+// class for objects that refer to an existing representation, e.g. the storage of a matrix
+// that is viewed transposed
+template<typename T, typename R>
+class A_View
+{
+private:
+    R const& rep_;
+
+public:
+    using value_type = T;
+    static constexpr bool packet_access = is_packet_accessible_v<R,T>;
+
+    explicit A_View(R const& r)
+        : rep_{r} { }
+
+    decltype(auto) operator[](std::size_t idx) const { return rep_[idx]; }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return rep_.load_packet(idx);
+    }
+
+    template<typename R2 = R>
+    auto data() const -> decltype(std::declval<R2 const&>().data()) { return rep_.data(); }
+
+    std::size_t size() const { return rep_.size(); }
+};
+
+
+// lazy transpose - a view of the same elements with the other layout
+template<typename T, typename R, typename L>
+Matrix<T, A_View<T,R>, transposed_layout_t<L>>
+transpose(Matrix<T,R,L> const& a)
+{
+    return Matrix<T, A_View<T,R>, transposed_layout_t<L>>
+            { A_View<T,R>{a.rep()}, a.cols(), a.rows() };
+}
+
+
+// Elementwise operations
+// The result has the layout of the left operand.
+/* --------------------------------------------------------------------------------------------- */
+template<template<typename...> class Node, typename T, typename L, typename R1, typename M2,
+         typename... Op>
+auto make_elementwise(Matrix<T,R1,L> const& a, M2 const& b)
+{
+    assert(a.rows() == b.rows() && a.cols() == b.cols());
+    using B = in_layout_t<L,M2>;
+    return Matrix<T, Node<T,R1,B,Op...>, L>{Node<T,R1,B,Op...>{a.rep(), in_layout<L>(b)},
+                                           a.rows(), a.cols()};
+}
+
+// addition
+template<typename T, typename R1, typename L1, typename R2, typename L2>
+auto operator+(Matrix<T,R1,L1> const& a, Matrix<T,R2,L2> const& b)
+{
+    return make_elementwise<A_Add>(a, b);
+}
+
+// subtraction
+template<typename T, typename R1, typename L1, typename R2, typename L2>
+auto operator-(Matrix<T,R1,L1> const& a, Matrix<T,R2,L2> const& b)
+{
+    return make_elementwise<A_Binary, T, L1, R1, Matrix<T,R2,L2>, OpSub>(a, b);
+}
+
+// elementwise (Hadamard) product - operator* is the matrix product
+template<typename T, typename R1, typename L1, typename R2, typename L2>
+auto hadamard(Matrix<T,R1,L1> const& a, Matrix<T,R2,L2> const& b)
+{
+    return make_elementwise<A_Mult>(a, b);
+}
+
+// multiplication of scalar and matrix
+template<typename T, typename R, typename L>
+Matrix<T, A_Mult<T,A_Scalar<T>,R>, L>
+operator*(T const& s, Matrix<T,R,L> const& b)
+{
+    return Matrix<T, A_Mult<T,A_Scalar<T>,R>, L>
+            { A_Mult<T,A_Scalar<T>,R>{A_Scalar<T>{s}, b.rep()}, b.rows(), b.cols() };
+}
+
+template<typename T, typename R, typename L>
+Matrix<T, A_Mult<T,A_Scalar<T>,R>, L>
+operator*(Matrix<T,R,L> const& a, T const& s)
+{
+    return s * a;
+}
+/* --------------------------------------------------------------------------------------------- */
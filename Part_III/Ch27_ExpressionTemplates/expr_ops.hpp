@@ -37,12 +37,586 @@ operator*(Array<T,R1> const& a, T const& s)
             { A_Mult<T, R1, A_Scalar<T>>{a.rep(), A_Scalar<T>{s}} };
 }
 
+
+// Rewrites
+// The overloads below are more specialized than the generic ones above, so they are
+// selected for the matching expression shapes and produce cheaper trees:
+// - constant folding: s1*(s2*x) and s1*(x*s2) become (s1*s2)*x
+// - fused multiply-add: a*b + c and c + a*b become A_FMA(a, b, c)
+// - repeated subexpressions: in e + e (with both e of the same type) A_Add checks at
+//   construction whether both operands are the same subexpression (see same_expr()), and
+//   the evaluation loops then evaluate it only once per index (see with_shared());
+//   A_Mult does the same for e * e. Repetitions other than the two operands of one node,
+//   e + e*z, are not detected.
+/* --------------------------------------------------------------------------------------------- */
+template<typename T, typename R2>
+Array<T, A_Mult<T,A_Scalar<T>,R2>>
+operator*(T const& s, Array<T, A_Mult<T,A_Scalar<T>,R2>> const& b)
+{
+    return Array<T, A_Mult<T,A_Scalar<T>,R2>>
+            { A_Mult<T, A_Scalar<T>, R2>{A_Scalar<T>{s * b.rep().first().value()},
+                                         b.rep().second()} };
+}
+
+template<typename T, typename R1>
+Array<T, A_Mult<T,A_Scalar<T>,R1>>
+operator*(T const& s, Array<T, A_Mult<T,R1,A_Scalar<T>>> const& b)
+{
+    return Array<T, A_Mult<T,A_Scalar<T>,R1>>
+            { A_Mult<T, A_Scalar<T>, R1>{A_Scalar<T>{s * b.rep().second().value()},
+                                         b.rep().first()} };
+}
+
+template<typename T, typename R2>
+Array<T, A_Mult<T,A_Scalar<T>,R2>>
+operator*(Array<T, A_Mult<T,A_Scalar<T>,R2>> const& a, T const& s)
+{
+    return s * a;
+}
+
+template<typename T, typename R1>
+Array<T, A_Mult<T,A_Scalar<T>,R1>>
+operator*(Array<T, A_Mult<T,R1,A_Scalar<T>>> const& a, T const& s)
+{
+    return s * a;
+}
+
+// a*b + c
+template<typename T, typename R1, typename R2, typename R3>
+Array<T, A_FMA<T,R1,R2,R3>>
+operator+(Array<T, A_Mult<T,R1,R2>> const& a, Array<T,R3> const& b)
+{
+    return Array<T, A_FMA<T,R1,R2,R3>>
+            { A_FMA<T,R1,R2,R3>{a.rep().first(), a.rep().second(), b.rep()} };
+}
+
+// c + a*b
+template<typename T, typename R1, typename R2, typename R3>
+Array<T, A_FMA<T,R2,R3,R1>>
+operator+(Array<T,R1> const& a, Array<T, A_Mult<T,R2,R3>> const& b)
+{
+    return Array<T, A_FMA<T,R2,R3,R1>>
+            { A_FMA<T,R2,R3,R1>{b.rep().first(), b.rep().second(), a.rep()} };
+}
+
+// a*b + c*d - fuse the first product, disambiguates the two overloads above
+template<typename T, typename R1, typename R2, typename R3, typename R4>
+Array<T, A_FMA<T,R1,R2,A_Mult<T,R3,R4>>>
+operator+(Array<T, A_Mult<T,R1,R2>> const& a, Array<T, A_Mult<T,R3,R4>> const& b)
+{
+    return Array<T, A_FMA<T,R1,R2,A_Mult<T,R3,R4>>>
+            { A_FMA<T,R1,R2,A_Mult<T,R3,R4>>{a.rep().first(), a.rep().second(), b.rep()} };
+}
+
+// e + e - operands of the same type, which might be the same subexpression
+template<typename T, typename R>
+Array<T, A_Add<T,R,R>>
+operator+(Array<T,R> const& a, Array<T,R> const& b)
+{
+    return Array<T, A_Add<T,R,R>>{A_Add<T,R,R>(a.rep(), b.rep())};
+}
+
+// a*b + a*b - more specialized than both the FMA and the e + e overload
+template<typename T, typename R1, typename R2>
+Array<T, A_Add<T,A_Mult<T,R1,R2>,A_Mult<T,R1,R2>>>
+operator+(Array<T, A_Mult<T,R1,R2>> const& a, Array<T, A_Mult<T,R1,R2>> const& b)
+{
+    using M = A_Mult<T,R1,R2>;
+    return Array<T, A_Add<T,M,M>>{A_Add<T,M,M>(a.rep(), b.rep())};
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// addition of scalar and array, and of array and scalar
+template<typename T, typename R2>
+Array<T, A_Add<T,A_Scalar<T>,R2>>
+operator+(T const& s, Array<T,R2> const& b)
+{
+    return Array<T, A_Add<T,A_Scalar<T>,R2>>
+            { A_Add<T,A_Scalar<T>,R2>{A_Scalar<T>{s}, b.rep()} };
+}
+
+template<typename T, typename R1>
+Array<T, A_Add<T,R1,A_Scalar<T>>>
+operator+(Array<T,R1> const& a, T const& s)
+{
+    return Array<T, A_Add<T,R1,A_Scalar<T>>>
+            { A_Add<T,R1,A_Scalar<T>>{a.rep(), A_Scalar<T>{s}} };
+}
+
+// a*b + s and s + a*b are fused multiply-adds as well
+template<typename T, typename R1, typename R2>
+Array<T, A_FMA<T,R1,R2,A_Scalar<T>>>
+operator+(Array<T, A_Mult<T,R1,R2>> const& a, T const& s)
+{
+    return Array<T, A_FMA<T,R1,R2,A_Scalar<T>>>
+            { A_FMA<T,R1,R2,A_Scalar<T>>{a.rep().first(), a.rep().second(), A_Scalar<T>{s}} };
+}
+
+template<typename T, typename R1, typename R2>
+Array<T, A_FMA<T,R1,R2,A_Scalar<T>>>
+operator+(T const& s, Array<T, A_Mult<T,R1,R2>> const& b)
+{
+    return b + s;
+}
+
+
+// The remaining operations are built on the generic nodes A_Binary, A_Unary, A_Compare and
+// A_Where (see expr_types.hpp). Like + and *, every operation is only recorded in the
+// expression tree, so any combination of them is still evaluated in a single loop -
+// a packet at a time as long as every node supports it.
+/* --------------------------------------------------------------------------------------------- */
+template<typename Op, typename T, typename R1, typename R2>
+Array<T, A_Binary<T,R1,R2,Op>>
+make_binary(R1 const& a, R2 const& b)
+{
+    return Array<T, A_Binary<T,R1,R2,Op>>{A_Binary<T,R1,R2,Op>{a, b}};
+}
+
+template<typename Cmp, typename T, typename R1, typename R2>
+Array<bool, A_Compare<T,R1,R2,Cmp>>
+make_compare(R1 const& a, R2 const& b)
+{
+    return Array<bool, A_Compare<T,R1,R2,Cmp>>{A_Compare<T,R1,R2,Cmp>{a, b}};
+}
+
+// subtraction
+template<typename T, typename R1, typename R2>
+Array<T, A_Binary<T,R1,R2,OpSub>>
+operator-(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_binary<OpSub,T>(a.rep(), b.rep());
+}
+
+template<typename T, typename R2>
+Array<T, A_Binary<T,A_Scalar<T>,R2,OpSub>>
+operator-(T const& s, Array<T,R2> const& b)
+{
+    return make_binary<OpSub,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<T, A_Binary<T,R1,A_Scalar<T>,OpSub>>
+operator-(Array<T,R1> const& a, T const& s)
+{
+    return make_binary<OpSub,T>(a.rep(), A_Scalar<T>{s});
+}
+
+// division
+template<typename T, typename R1, typename R2>
+Array<T, A_Binary<T,R1,R2,OpDiv>>
+operator/(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_binary<OpDiv,T>(a.rep(), b.rep());
+}
+
+template<typename T, typename R2>
+Array<T, A_Binary<T,A_Scalar<T>,R2,OpDiv>>
+operator/(T const& s, Array<T,R2> const& b)
+{
+    return make_binary<OpDiv,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<T, A_Binary<T,R1,A_Scalar<T>,OpDiv>>
+operator/(Array<T,R1> const& a, T const& s)
+{
+    return make_binary<OpDiv,T>(a.rep(), A_Scalar<T>{s});
+}
+
+// elementwise minimum and maximum (the one-argument min(a) and max(a) in
+// expr_reduce.hpp are reductions)
+template<typename T, typename R1, typename R2>
+Array<T, A_Binary<T,R1,R2,OpMin>>
+min(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_binary<OpMin,T>(a.rep(), b.rep());
+}
+
+template<typename T, typename R2>
+Array<T, A_Binary<T,A_Scalar<T>,R2,OpMin>>
+min(T const& s, Array<T,R2> const& b)
+{
+    return make_binary<OpMin,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<T, A_Binary<T,R1,A_Scalar<T>,OpMin>>
+min(Array<T,R1> const& a, T const& s)
+{
+    return make_binary<OpMin,T>(a.rep(), A_Scalar<T>{s});
+}
+
+template<typename T, typename R1, typename R2>
+Array<T, A_Binary<T,R1,R2,OpMax>>
+max(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_binary<OpMax,T>(a.rep(), b.rep());
+}
+template<typename T, typename R2>
+Array<T, A_Binary<T,A_Scalar<T>,R2,OpMax>>
+max(T const& s, Array<T,R2> const& b)
+{
+    return make_binary<OpMax,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<T, A_Binary<T,R1,A_Scalar<T>,OpMax>>
+max(Array<T,R1> const& a, T const& s)
+{
+    return make_binary<OpMax,T>(a.rep(), A_Scalar<T>{s});
+}
+
+// negation
+template<typename T, typename R>
+Array<T, A_Unary<T,R,OpNeg>>
+operator-(Array<T,R> const& a)
+{
+    return Array<T, A_Unary<T,R,OpNeg>>{A_Unary<T,R,OpNeg>{a.rep()}};
+}
+
+// elementwise math functions
+template<typename T, typename R>
+Array<T, A_Unary<T,R,OpAbs>>
+abs(Array<T,R> const& a)
+{
+    return Array<T, A_Unary<T,R,OpAbs>>{A_Unary<T,R,OpAbs>{a.rep()}};
+}
+
+template<typename T, typename R>
+Array<T, A_Unary<T,R,OpSqrt>>
+sqrt(Array<T,R> const& a)
+{
+    return Array<T, A_Unary<T,R,OpSqrt>>{A_Unary<T,R,OpSqrt>{a.rep()}};
+}
+
+template<typename T, typename R>
+Array<T, A_Unary<T,R,OpExp>>
+exp(Array<T,R> const& a)
+{
+    return Array<T, A_Unary<T,R,OpExp>>{A_Unary<T,R,OpExp>{a.rep()}};
+}
+
+template<typename T, typename R>
+Array<T, A_Unary<T,R,OpLog>>
+log(Array<T,R> const& a)
+{
+    return Array<T, A_Unary<T,R,OpLog>>{A_Unary<T,R,OpLog>{a.rep()}};
+}
+
+// comparisons - the result is a mask array of bools, which can be stored in an Array<bool>
+// or used directly as the condition of where()
+template<typename T, typename R1, typename R2>
+Array<bool, A_Compare<T,R1,R2,CmpLess>>
+operator<(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_compare<CmpLess,T>(a.rep(), b.rep());
+}
+
+template<typename T, typename R2>
+Array<bool, A_Compare<T,A_Scalar<T>,R2,CmpLess>>
+operator<(T const& s, Array<T,R2> const& b)
+{
+    return make_compare<CmpLess,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<bool, A_Compare<T,R1,A_Scalar<T>,CmpLess>>
+operator<(Array<T,R1> const& a, T const& s)
+{
+    return make_compare<CmpLess,T>(a.rep(), A_Scalar<T>{s});
+}
+
+template<typename T, typename R1, typename R2>
+Array<bool, A_Compare<T,R1,R2,CmpLessEqual>>
+operator<=(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_compare<CmpLessEqual,T>(a.rep(), b.rep());
+}
+
+template<typename T, typename R2>
+Array<bool, A_Compare<T,A_Scalar<T>,R2,CmpLessEqual>>
+operator<=(T const& s, Array<T,R2> const& b)
+{
+    return make_compare<CmpLessEqual,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<bool, A_Compare<T,R1,A_Scalar<T>,CmpLessEqual>>
+operator<=(Array<T,R1> const& a, T const& s)
+{
+    return make_compare<CmpLessEqual,T>(a.rep(), A_Scalar<T>{s});
+}
+
+template<typename T, typename R1, typename R2>
+Array<bool, A_Compare<T,R1,R2,CmpGreater>>
+operator>(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_compare<CmpGreater,T>(a.rep(), b.rep());
+}
+
+template<typename T, typename R2>
+Array<bool, A_Compare<T,A_Scalar<T>,R2,CmpGreater>>
+operator>(T const& s, Array<T,R2> const& b)
+{
+    return make_compare<CmpGreater,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<bool, A_Compare<T,R1,A_Scalar<T>,CmpGreater>>
+operator>(Array<T,R1> const& a, T const& s)
+{
+    return make_compare<CmpGreater,T>(a.rep(), A_Scalar<T>{s});
+}
+
+template<typename T, typename R1, typename R2>
+Array<bool, A_Compare<T,R1,R2,CmpGreaterEqual>>
+operator>=(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_compare<CmpGreaterEqual,T>(a.rep(), b.rep());
+}
+
 template<typename T, typename R2>
-Array<T, A_Add<T, A_Scalar<T>, R2>>
-operator+(A_Scalar<T> const& s, Array<T,R2> const& b)
+Array<bool, A_Compare<T,A_Scalar<T>,R2,CmpGreaterEqual>>
+operator>=(T const& s, Array<T,R2> const& b)
+{
+    return make_compare<CmpGreaterEqual,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<bool, A_Compare<T,R1,A_Scalar<T>,CmpGreaterEqual>>
+operator>=(Array<T,R1> const& a, T const& s)
+{
+    return make_compare<CmpGreaterEqual,T>(a.rep(), A_Scalar<T>{s});
+}
+
+template<typename T, typename R1, typename R2>
+Array<bool, A_Compare<T,R1,R2,CmpEqual>>
+operator==(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_compare<CmpEqual,T>(a.rep(), b.rep());
+}
+
+template<typename T, typename R2>
+Array<bool, A_Compare<T,A_Scalar<T>,R2,CmpEqual>>
+operator==(T const& s, Array<T,R2> const& b)
+{
+    return make_compare<CmpEqual,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<bool, A_Compare<T,R1,A_Scalar<T>,CmpEqual>>
+operator==(Array<T,R1> const& a, T const& s)
+{
+    return make_compare<CmpEqual,T>(a.rep(), A_Scalar<T>{s});
+}
+
+template<typename T, typename R1, typename R2>
+Array<bool, A_Compare<T,R1,R2,CmpNotEqual>>
+operator!=(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return make_compare<CmpNotEqual,T>(a.rep(), b.rep());
+}
+
+template<typename T, typename R2>
+Array<bool, A_Compare<T,A_Scalar<T>,R2,CmpNotEqual>>
+operator!=(T const& s, Array<T,R2> const& b)
+{
+    return make_compare<CmpNotEqual,T>(A_Scalar<T>{s}, b.rep());
+}
+
+template<typename T, typename R1>
+Array<bool, A_Compare<T,R1,A_Scalar<T>,CmpNotEqual>>
+operator!=(Array<T,R1> const& a, T const& s)
+{
+    return make_compare<CmpNotEqual,T>(a.rep(), A_Scalar<T>{s});
+}
+
+// where(mask, a, b) - a where the mask is set, b elsewhere
+template<typename M, typename T, typename R1, typename R2>
+Array<T, A_Where<T,M,R1,R2>>
+where(Array<bool,M> const& mask, Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return Array<T, A_Where<T,M,R1,R2>>{A_Where<T,M,R1,R2>{mask.rep(), a.rep(), b.rep()}};
+}
+
+template<typename M, typename T, typename R1>
+Array<T, A_Where<T,M,R1,A_Scalar<T>>>
+where(Array<bool,M> const& mask, Array<T,R1> const& a, T const& s)
+{
+    return Array<T, A_Where<T,M,R1,A_Scalar<T>>>
+            { A_Where<T,M,R1,A_Scalar<T>>{mask.rep(), a.rep(), A_Scalar<T>{s}} };
+}
+
+template<typename M, typename T, typename R2>
+Array<T, A_Where<T,M,A_Scalar<T>,R2>>
+where(Array<bool,M> const& mask, T const& s, Array<T,R2> const& b)
+{
+    return Array<T, A_Where<T,M,A_Scalar<T>,R2>>
+            { A_Where<T,M,A_Scalar<T>,R2>{mask.rep(), A_Scalar<T>{s}, b.rep()} };
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// Mixed precision
+// Operands of different types are combined in their promoted type (see promoted_t in
+// expr_types.hpp): 2.5*x for a float array x is a double expression which reads x as floats.
+// The rewrites above only apply to operands of a single type.
+/* --------------------------------------------------------------------------------------------- */
+// the representation of an operand as an operand of type T
+template<typename T, typename T1, typename R>
+decltype(auto) promote_rep(Array<T1,R> const& a)
+{
+    if constexpr (std::is_same_v<T,T1>) {
+        return (a.rep());
+    }
+    else {
+        return A_Convert<T,R>{a.rep()};
+    }
+}
+
+// (scalars are converted right away)
+template<typename T, typename T1>
+A_Scalar<T> promote_rep(Array<T1,A_Scalar<T1>> const& a)
+{
+    return A_Scalar<T>{static_cast<T>(a.rep().value())};
+}
+
+template<typename T, typename T1, typename R>
+using promoted_rep_t = std::decay_t<decltype(promote_rep<T>(std::declval<Array<T1,R> const&>()))>;
+
+// the node Node<T, ..., Op...> for the operands a and b in their promoted type T
+template<template<typename...> class Node, typename... Op,
+         typename T1, typename R1, typename T2, typename R2>
+auto make_promoted(Array<T1,R1> const& a, Array<T2,R2> const& b)
+{
+    using T = promoted_t<T1,T2>;
+    using N = Node<T, promoted_rep_t<T,T1,R1>, promoted_rep_t<T,T2,R2>, Op...>;
+    return Array<T,N>{N{promote_rep<T>(a), promote_rep<T>(b)}};
+}
+
+template<typename S>
+Array<S, A_Scalar<S>> scalar_operand(S const& s)
+{
+    return Array<S, A_Scalar<S>>{A_Scalar<S>{s}};
+}
+
+template<typename T1, typename T2>
+using enable_if_mixed_t = std::enable_if_t<!std::is_same_v<T1,T2>>;
+
+template<typename S, typename T>
+using enable_if_mixed_scalar_t = std::enable_if_t<std::is_arithmetic_v<S> && !std::is_same_v<S,T>>;
+
+// addition
+template<typename T1, typename R1, typename T2, typename R2, typename = enable_if_mixed_t<T1,T2>>
+auto operator+(Array<T1,R1> const& a, Array<T2,R2> const& b)
 {
-    return Array<T, A_Add<T, A_Scalar<T>, R2>>
-            { A_Add<T, A_Scalar<T>, R2>{A_Scalar<T>{s}, b.rep()} };
+    return make_promoted<A_Add>(a, b);
 }
 
-// etc...
+template<typename S, typename T, typename R, typename = enable_if_mixed_scalar_t<S,T>>
+auto operator+(S const& s, Array<T,R> const& b)
+{
+    return make_promoted<A_Add>(scalar_operand(s), b);
+}
+
+template<typename T, typename R, typename S, typename = enable_if_mixed_scalar_t<S,T>>
+auto operator+(Array<T,R> const& a, S const& s)
+{
+    return make_promoted<A_Add>(a, scalar_operand(s));
+}
+
+// multiplication
+template<typename T1, typename R1, typename T2, typename R2, typename = enable_if_mixed_t<T1,T2>>
+auto operator*(Array<T1,R1> const& a, Array<T2,R2> const& b)
+{
+    return make_promoted<A_Mult>(a, b);
+}
+
+template<typename S, typename T, typename R, typename = enable_if_mixed_scalar_t<S,T>>
+auto operator*(S const& s, Array<T,R> const& b)
+{
+    return make_promoted<A_Mult>(scalar_operand(s), b);
+}
+
+template<typename T, typename R, typename S, typename = enable_if_mixed_scalar_t<S,T>>
+auto operator*(Array<T,R> const& a, S const& s)
+{
+    return make_promoted<A_Mult>(a, scalar_operand(s));
+}
+
+// subtraction
+template<typename T1, typename R1, typename T2, typename R2, typename = enable_if_mixed_t<T1,T2>>
+auto operator-(Array<T1,R1> const& a, Array<T2,R2> const& b)
+{
+    return make_promoted<A_Binary, OpSub>(a, b);
+}
+
+template<typename S, typename T, typename R, typename = enable_if_mixed_scalar_t<S,T>>
+auto operator-(S const& s, Array<T,R> const& b)
+{
+    return make_promoted<A_Binary, OpSub>(scalar_operand(s), b);
+}
+
+template<typename T, typename R, typename S, typename = enable_if_mixed_scalar_t<S,T>>
+auto operator-(Array<T,R> const& a, S const& s)
+{
+    return make_promoted<A_Binary, OpSub>(a, scalar_operand(s));
+}
+
+// division
+template<typename T1, typename R1, typename T2, typename R2, typename = enable_if_mixed_t<T1,T2>>
+auto operator/(Array<T1,R1> const& a, Array<T2,R2> const& b)
+{
+    return make_promoted<A_Binary, OpDiv>(a, b);
+}
+
+template<typename S, typename T, typename R, typename = enable_if_mixed_scalar_t<S,T>>
+auto operator/(S const& s, Array<T,R> const& b)
+{
+    return make_promoted<A_Binary, OpDiv>(scalar_operand(s), b);
+}
+
+template<typename T, typename R, typename S, typename = enable_if_mixed_scalar_t<S,T>>
+auto operator/(Array<T,R> const& a, S const& s)
+{
+    return make_promoted<A_Binary, OpDiv>(a, scalar_operand(s));
+}
+
+// minimum and maximum
+template<typename T1, typename R1, typename T2, typename R2, typename = enable_if_mixed_t<T1,T2>>
+auto min(Array<T1,R1> const& a, Array<T2,R2> const& b)
+{
+    return make_promoted<A_Binary, OpMin>(a, b);
+}
+
+template<typename S, typename T, typename R, typename = enable_if_mixed_scalar_t<S,T>>
+auto min(S const& s, Array<T,R> const& b)
+{
+    return make_promoted<A_Binary, OpMin>(scalar_operand(s), b);
+}
+
+template<typename T, typename R, typename S, typename = enable_if_mixed_scalar_t<S,T>>
+auto min(Array<T,R> const& a, S const& s)
+{
+    return make_promoted<A_Binary, OpMin>(a, scalar_operand(s));
+}
+
+template<typename T1, typename R1, typename T2, typename R2, typename = enable_if_mixed_t<T1,T2>>
+auto max(Array<T1,R1> const& a, Array<T2,R2> const& b)
+{
+    return make_promoted<A_Binary, OpMax>(a, b);
+}
+
+template<typename S, typename T, typename R, typename = enable_if_mixed_scalar_t<S,T>>
+auto max(S const& s, Array<T,R> const& b)
+{
+    return make_promoted<A_Binary, OpMax>(scalar_operand(s), b);
+}
+
+template<typename T, typename R, typename S, typename = enable_if_mixed_scalar_t<S,T>>
+auto max(Array<T,R> const& a, S const& s)
+{
+    return make_promoted<A_Binary, OpMax>(a, scalar_operand(s));
+}
+/* --------------------------------------------------------------------------------------------- */
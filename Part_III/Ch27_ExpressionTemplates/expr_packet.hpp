@@ -0,0 +1,467 @@
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include <type_traits>
+#if defined(__SSE2__) || defined(__AVX__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// A "packet" is a chunk of consecutive elements that fits in a single SIMD register.
+// Packet<T> describes the widest register the translation unit was compiled for
+// (selected at compile time via the predefined target macros, e.g. -mavx2 or -march=native)
+// and the handful of operations the expression template nodes need. Comparisons yield a
+// Packet<T>::mask_type (a bit mask with AVX-512, a register of all-ones/all-zeros lanes
+// otherwise), which select() consumes.
+//
+// The primary template is the scalar fallback - a packet of one element. The evaluation loop
+// only takes the packet path when Packet<T>::size > 1.
+
+// primary template - no SIMD support for T
+template<typename T>
+struct Packet
+{
+    using type = T;
+    static constexpr std::size_t size = 1;
+
+    static type load(T const* p) { return *p; }
+    static void store(T* p, type v) { *p = v; }
+    static type broadcast(T v) { return v; }
+    static type add(type a, type b) { return a + b; }
+    static type sub(type a, type b) { return a - b; }
+    static type mul(type a, type b) { return a * b; }
+    static type fmadd(type a, type b, type c) { return a * b + c; }
+    static type min(type a, type b) { return b < a ? b : a; }
+    static type max(type a, type b) { return a < b ? b : a; }
+    static type div(type a, type b) { return a / b; }
+    static type neg(type a) { return -a; }
+    static type abs(type a) { return std::abs(a); }
+    static type sqrt(type a) { return std::sqrt(a); }
+
+    // comparisons produce a mask, select() picks a where the mask is set, b elsewhere
+    using mask_type = bool;
+    static mask_type lt(type a, type b) { return a < b; }
+    static mask_type le(type a, type b) { return a <= b; }
+    static mask_type gt(type a, type b) { return a > b; }
+    static mask_type ge(type a, type b) { return a >= b; }
+    static mask_type eq(type a, type b) { return a == b; }
+    static mask_type ne(type a, type b) { return a != b; }
+    static type select(mask_type m, type a, type b) { return m ? a : b; }
+};
+
+#if defined(__AVX512F__)
+
+template<>
+struct Packet<double>
+{
+    using type = __m512d;
+    static constexpr std::size_t size = 8;
+
+    static type load(double const* p) { return _mm512_loadu_pd(p); }
+    static void store(double* p, type v) { _mm512_storeu_pd(p, v); }
+    static type broadcast(double v) { return _mm512_set1_pd(v); }
+    static type add(type a, type b) { return _mm512_add_pd(a, b); }
+    static type sub(type a, type b) { return _mm512_sub_pd(a, b); }
+    static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+    static type fmadd(type a, type b, type c) { return _mm512_fmadd_pd(a, b, c); }
+    // (the zero-masked forms avoid a spurious -Wmaybe-uninitialized from GCC's headers)
+    static type min(type a, type b) { return _mm512_maskz_min_pd(0xFF, a, b); }
+    static type max(type a, type b) { return _mm512_maskz_max_pd(0xFF, a, b); }
+    static type div(type a, type b) { return _mm512_div_pd(a, b); }
+    static type neg(type a) { return sub(broadcast(-0.0), a); }
+    static type abs(type a) { return _mm512_abs_pd(a); }
+    static type sqrt(type a) { return _mm512_maskz_sqrt_pd(0xFF, a); }
+
+    using mask_type = __mmask8;
+    static mask_type lt(type a, type b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static mask_type le(type a, type b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+    static mask_type gt(type a, type b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+    static mask_type ge(type a, type b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+    static mask_type eq(type a, type b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+    static mask_type ne(type a, type b) { return _mm512_cmp_pd_mask(a, b, _CMP_NEQ_UQ); }
+    static type select(mask_type m, type a, type b) { return _mm512_mask_blend_pd(m, b, a); }
+};
+
+template<>
+struct Packet<float>
+{
+    using type = __m512;
+    static constexpr std::size_t size = 16;
+
+    static type load(float const* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, type v) { _mm512_storeu_ps(p, v); }
+    static type broadcast(float v) { return _mm512_set1_ps(v); }
+    static type add(type a, type b) { return _mm512_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm512_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+    static type fmadd(type a, type b, type c) { return _mm512_fmadd_ps(a, b, c); }
+    static type min(type a, type b) { return _mm512_maskz_min_ps(0xFFFF, a, b); }
+    static type max(type a, type b) { return _mm512_maskz_max_ps(0xFFFF, a, b); }
+    static type div(type a, type b) { return _mm512_div_ps(a, b); }
+    static type neg(type a) { return sub(broadcast(-0.0f), a); }
+    static type abs(type a) { return _mm512_abs_ps(a); }
+    static type sqrt(type a) { return _mm512_maskz_sqrt_ps(0xFFFF, a); }
+
+    using mask_type = __mmask16;
+    static mask_type lt(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static mask_type le(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    static mask_type gt(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static mask_type ge(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+    static mask_type eq(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    static mask_type ne(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ); }
+    static type select(mask_type m, type a, type b) { return _mm512_mask_blend_ps(m, b, a); }
+};
+
+#elif defined(__AVX__)
+
+template<>
+struct Packet<double>
+{
+    using type = __m256d;
+    static constexpr std::size_t size = 4;
+
+    static type load(double const* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+    static type broadcast(double v) { return _mm256_set1_pd(v); }
+    static type add(type a, type b) { return _mm256_add_pd(a, b); }
+    static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+    static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+#if defined(__FMA__)
+    static type fmadd(type a, type b, type c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+    static type fmadd(type a, type b, type c) { return add(mul(a, b), c); }
+#endif
+    static type min(type a, type b) { return _mm256_min_pd(a, b); }
+    static type max(type a, type b) { return _mm256_max_pd(a, b); }
+    static type div(type a, type b) { return _mm256_div_pd(a, b); }
+    static type neg(type a) { return _mm256_xor_pd(a, broadcast(-0.0)); }
+    static type abs(type a) { return _mm256_andnot_pd(broadcast(-0.0), a); }
+    static type sqrt(type a) { return _mm256_sqrt_pd(a); }
+
+    using mask_type = type;
+    static mask_type lt(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static mask_type le(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static mask_type gt(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static mask_type ge(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static mask_type eq(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static mask_type ne(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+    static type select(mask_type m, type a, type b) { return _mm256_blendv_pd(b, a, m); }
+};
+
+template<>
+struct Packet<float>
+{
+    using type = __m256;
+    static constexpr std::size_t size = 8;
+
+    static type load(float const* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, type v) { _mm256_storeu_ps(p, v); }
+    static type broadcast(float v) { return _mm256_set1_ps(v); }
+    static type add(type a, type b) { return _mm256_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__)
+    static type fmadd(type a, type b, type c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+    static type fmadd(type a, type b, type c) { return add(mul(a, b), c); }
+#endif
+    static type min(type a, type b) { return _mm256_min_ps(a, b); }
+    static type max(type a, type b) { return _mm256_max_ps(a, b); }
+    static type div(type a, type b) { return _mm256_div_ps(a, b); }
+    static type neg(type a) { return _mm256_xor_ps(a, broadcast(-0.0f)); }
+    static type abs(type a) { return _mm256_andnot_ps(broadcast(-0.0f), a); }
+    static type sqrt(type a) { return _mm256_sqrt_ps(a); }
+
+    using mask_type = type;
+    static mask_type lt(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static mask_type le(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static mask_type gt(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static mask_type ge(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static mask_type eq(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static mask_type ne(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+    static type select(mask_type m, type a, type b) { return _mm256_blendv_ps(b, a, m); }
+};
+
+#elif defined(__SSE2__)
+
+template<>
+struct Packet<double>
+{
+    using type = __m128d;
+    static constexpr std::size_t size = 2;
+
+    static type load(double const* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, type v) { _mm_storeu_pd(p, v); }
+    static type broadcast(double v) { return _mm_set1_pd(v); }
+    static type add(type a, type b) { return _mm_add_pd(a, b); }
+    static type sub(type a, type b) { return _mm_sub_pd(a, b); }
+    static type mul(type a, type b) { return _mm_mul_pd(a, b); }
+#if defined(__FMA__)
+    static type fmadd(type a, type b, type c) { return _mm_fmadd_pd(a, b, c); }
+#else
+    static type fmadd(type a, type b, type c) { return add(mul(a, b), c); }
+#endif
+    static type min(type a, type b) { return _mm_min_pd(a, b); }
+    static type max(type a, type b) { return _mm_max_pd(a, b); }
+    static type div(type a, type b) { return _mm_div_pd(a, b); }
+    static type neg(type a) { return _mm_xor_pd(a, broadcast(-0.0)); }
+    static type abs(type a) { return _mm_andnot_pd(broadcast(-0.0), a); }
+    static type sqrt(type a) { return _mm_sqrt_pd(a); }
+
+    using mask_type = type;
+    static mask_type lt(type a, type b) { return _mm_cmplt_pd(a, b); }
+    static mask_type le(type a, type b) { return _mm_cmple_pd(a, b); }
+    static mask_type gt(type a, type b) { return _mm_cmpgt_pd(a, b); }
+    static mask_type ge(type a, type b) { return _mm_cmpge_pd(a, b); }
+    static mask_type eq(type a, type b) { return _mm_cmpeq_pd(a, b); }
+    static mask_type ne(type a, type b) { return _mm_cmpneq_pd(a, b); }
+#if defined(__SSE4_1__)
+    static type select(mask_type m, type a, type b) { return _mm_blendv_pd(b, a, m); }
+#else
+    // (no blendv before SSE4.1)
+    static type select(mask_type m, type a, type b) {
+        return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+    }
+#endif
+};
+
+template<>
+struct Packet<float>
+{
+    using type = __m128;
+    static constexpr std::size_t size = 4;
+
+    static type load(float const* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, type v) { _mm_storeu_ps(p, v); }
+    static type broadcast(float v) { return _mm_set1_ps(v); }
+    static type add(type a, type b) { return _mm_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+#if defined(__FMA__)
+    static type fmadd(type a, type b, type c) { return _mm_fmadd_ps(a, b, c); }
+#else
+    static type fmadd(type a, type b, type c) { return add(mul(a, b), c); }
+#endif
+    static type min(type a, type b) { return _mm_min_ps(a, b); }
+    static type max(type a, type b) { return _mm_max_ps(a, b); }
+    static type div(type a, type b) { return _mm_div_ps(a, b); }
+    static type neg(type a) { return _mm_xor_ps(a, broadcast(-0.0f)); }
+    static type abs(type a) { return _mm_andnot_ps(broadcast(-0.0f), a); }
+    static type sqrt(type a) { return _mm_sqrt_ps(a); }
+
+    using mask_type = type;
+    static mask_type lt(type a, type b) { return _mm_cmplt_ps(a, b); }
+    static mask_type le(type a, type b) { return _mm_cmple_ps(a, b); }
+    static mask_type gt(type a, type b) { return _mm_cmpgt_ps(a, b); }
+    static mask_type ge(type a, type b) { return _mm_cmpge_ps(a, b); }
+    static mask_type eq(type a, type b) { return _mm_cmpeq_ps(a, b); }
+    static mask_type ne(type a, type b) { return _mm_cmpneq_ps(a, b); }
+#if defined(__SSE4_1__)
+    static type select(mask_type m, type a, type b) { return _mm_blendv_ps(b, a, m); }
+#else
+    // (no blendv before SSE4.1)
+    static type select(mask_type m, type a, type b) {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+#endif
+};
+
+#endif
+
+// does T have a real (wider than one element) packet type
+template<typename T>
+constexpr inline bool has_packet_v = Packet<T>::size > 1;
+
+
+// PacketGather<T,Index>::gather(base, idx) loads the packet
+//   base[idx[0]], base[idx[1]], ..., base[idx[Packet<T>::size - 1]]
+// with a single gather instruction, if the target has one for this value and index type.
+// 32-bit indices must be signed, since the instructions sign-extend them.
+template<typename T, typename Index, typename = void>
+struct PacketGather
+{
+    static constexpr bool value = false;
+};
+
+template<typename Index, std::size_t Bytes>
+constexpr inline bool is_gather_index_v = std::is_integral_v<Index> && sizeof(Index) == Bytes
+                                          && (Bytes == 8 || std::is_signed_v<Index>);
+
+#if defined(__AVX512F__)
+
+template<typename Index>
+struct PacketGather<double, Index, std::enable_if_t<is_gather_index_v<Index,4>>>
+{
+    static constexpr bool value = true;
+    static __m512d gather(double const* base, Index const* idx) {
+        return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF,
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx)), base, 8);
+    }
+};
+
+template<typename Index>
+struct PacketGather<double, Index, std::enable_if_t<is_gather_index_v<Index,8>>>
+{
+    static constexpr bool value = true;
+    static __m512d gather(double const* base, Index const* idx) {
+        return _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF,
+                                        _mm512_loadu_si512(idx), base, 8);
+    }
+};
+
+template<typename Index>
+struct PacketGather<float, Index, std::enable_if_t<is_gather_index_v<Index,4>>>
+{
+    static constexpr bool value = true;
+    static __m512 gather(float const* base, Index const* idx) {
+        return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF,
+                                        _mm512_loadu_si512(idx), base, 4);
+    }
+};
+
+#elif defined(__AVX2__)
+
+// (the masked forms with an all-ones mask avoid a spurious -Wmaybe-uninitialized
+//  from GCC's headers)
+inline __m256d all_lanes() { return _mm256_castsi256_pd(_mm256_set1_epi64x(-1)); }
+
+template<typename Index>
+struct PacketGather<double, Index, std::enable_if_t<is_gather_index_v<Index,4>>>
+{
+    static constexpr bool value = true;
+    static __m256d gather(double const* base, Index const* idx) {
+        return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base,
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(idx)), all_lanes(), 8);
+    }
+};
+
+template<typename Index>
+struct PacketGather<double, Index, std::enable_if_t<is_gather_index_v<Index,8>>>
+{
+    static constexpr bool value = true;
+    static __m256d gather(double const* base, Index const* idx) {
+        return _mm256_mask_i64gather_pd(_mm256_setzero_pd(), base,
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx)), all_lanes(), 8);
+    }
+};
+
+template<typename Index>
+struct PacketGather<float, Index, std::enable_if_t<is_gather_index_v<Index,4>>>
+{
+    static constexpr bool value = true;
+    static __m256 gather(float const* base, Index const* idx) {
+        return _mm256_mask_i32gather_ps(_mm256_setzero_ps(), base,
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx)),
+            _mm256_castsi256_ps(_mm256_set1_epi32(-1)), 4);
+    }
+};
+
+#endif
+
+template<typename T, typename Index>
+constexpr inline bool has_packet_gather_v = PacketGather<T,Index>::value;
+
+
+// PacketConvert<T,S> converts between a packet of T and Packet<T>::size consecutive elements
+// of another type S in memory, if the target has instructions for it:
+//   load(p)     - the elements p[0], ..., p[Packet<T>::size - 1], converted to T
+//   store(p, v) - the elements of v, converted to S and stored to p[0], p[1], ...
+// E.g. PacketConvert<double,float> reads floats into a double expression and narrows the
+// result of one when it is stored. (See float16.hpp for the 16-bit storage formats.)
+template<typename T, typename S, typename = void>
+struct PacketConvert
+{
+    static constexpr bool value = false;
+};
+
+#if defined(__AVX512F__)
+
+template<>
+struct PacketConvert<double, float>
+{
+    static constexpr bool value = true;
+    static __m512d load(float const* p) {
+        return _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(p));
+    }
+    static void store(float* p, __m512d v) {
+        _mm256_storeu_ps(p, _mm512_maskz_cvtpd_ps(0xFF, v));
+    }
+};
+
+#elif defined(__AVX__)
+
+template<>
+struct PacketConvert<double, float>
+{
+    static constexpr bool value = true;
+    static __m256d load(float const* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+    static void store(float* p, __m256d v) { _mm_storeu_ps(p, _mm256_cvtpd_ps(v)); }
+};
+
+#elif defined(__SSE2__)
+
+template<>
+struct PacketConvert<double, float>
+{
+    static constexpr bool value = true;
+    static __m128d load(float const* p) {
+        return _mm_cvtps_pd(_mm_castsi128_ps(
+            _mm_loadl_epi64(reinterpret_cast<__m128i const*>(p))));
+    }
+    static void store(float* p, __m128d v) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_castps_si128(_mm_cvtpd_ps(v)));
+    }
+};
+
+#endif
+
+template<typename T, typename S>
+constexpr inline bool has_packet_convert_v = PacketConvert<T,S>::value;
+
+
+// Detect whether an expression node (or array representation) supports packet access, i.e.
+// declares `static constexpr bool packet_access = true;` and provides `load_packet(idx)`.
+// The value type must match, so that nodes never mix packets of different types.
+template<typename E, typename T, typename = std::void_t<>>
+struct is_packet_accessible : std::false_type { };
+
+template<typename E, typename T>
+struct is_packet_accessible<E, T, std::void_t<decltype(E::packet_access),
+                                              typename E::value_type>>
+    : std::bool_constant<E::packet_access && std::is_same_v<typename E::value_type, T>> { };
+
+template<typename E, typename T>
+constexpr inline bool is_packet_accessible_v = is_packet_accessible<E,T>::value;
+
+
+// Detect whether an array representation can be written to a packet at a time.
+template<typename E, typename T, typename = std::void_t<>>
+struct is_packet_storable : std::false_type { };
+
+template<typename E, typename T>
+struct is_packet_storable<E, T, std::void_t<decltype(std::declval<E&>().store_packet(
+                                    std::size_t{}, std::declval<typename Packet<T>::type>()))>>
+    : std::true_type { };
+
+template<typename E, typename T>
+constexpr inline bool is_packet_storable_v = is_packet_storable<E,T>::value;
+
+
+// can the expression `src` be assigned to `dst` a packet at a time
+template<typename T, typename Dst, typename Src>
+constexpr inline bool is_packet_evaluable_v = has_packet_v<T>
+                                              && is_packet_storable_v<Dst,T>
+                                              && is_packet_accessible_v<Src,T>;
+
+
+// Detect array representations that keep their elements contiguously in memory,
+// i.e. provide data().
+template<typename E, typename = std::void_t<>>
+struct has_contiguous_data : std::false_type { };
+
+template<typename E>
+struct has_contiguous_data<E, std::void_t<decltype(std::declval<E const&>().data())>>
+    : std::true_type { };
+
+template<typename E>
+constexpr inline bool has_contiguous_data_v = has_contiguous_data<E>::value;
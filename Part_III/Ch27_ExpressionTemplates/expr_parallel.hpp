@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "expr_array.hpp"
+#include "expr_eval.hpp"
+#include "expr_alias.hpp"
+
+
+// A minimal fixed-size thread pool. run(f) calls f(worker_index) once on every worker
+// (the calling thread acts as worker 0) and returns when all of them have finished.
+// The work passed to run() must not throw.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency())
+    {
+        for (std::size_t w = 1; w < std::max<std::size_t>(threads, 1); ++w) {
+            workers_.emplace_back([this, w]{ worker_loop(w); });
+        }
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    // number of threads taking part in run(), including the caller
+    std::size_t size() const { return workers_.size() + 1; }
+
+    template<typename F>
+    void run(F&& f)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            job_ = std::ref(f);
+            pending_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+        f(std::size_t{0});
+
+        std::unique_lock<std::mutex> lock{mutex_};
+        done_.wait(lock, [this]{ return pending_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void worker_loop(std::size_t index)
+    {
+        std::size_t seen = 0;
+        for (;;) {
+            std::function<void(std::size_t)> job;
+            {
+                std::unique_lock<std::mutex> lock{mutex_};
+                wake_.wait(lock, [&]{ return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+                job = job_;
+            }
+            job(index);
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                if (--pending_ == 0) {
+                    done_.notify_one();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_{};
+    std::mutex mutex_{};
+    std::condition_variable wake_{};
+    std::condition_variable done_{};
+    std::function<void(std::size_t)> job_{};
+    std::size_t generation_{0};
+    std::size_t pending_{0};
+    bool stop_{false};
+};
+
+
+// How to split an assignment between the threads of a pool.
+struct ParallelPolicy
+{
+    ThreadPool& pool;
+    std::size_t threshold{1u << 16};        // arrays smaller than this are evaluated serially
+    std::size_t chunk_bytes{128u * 1024u};  // destination bytes per chunk, ~ half of a L2 cache
+};
+
+// the chunks of dst = src for [0, n), dealt out to the workers
+template<typename T, typename Dst, typename Src>
+void parallel_chunks(Dst& dst, Src const& src, std::size_t n, ParallelPolicy const& policy)
+{
+    std::size_t const threads = policy.pool.size();
+
+    // whole packets per chunk, so that only the very last chunk runs a scalar tail
+    constexpr std::size_t width = Packet<T>::size;
+    std::size_t const chunk = std::max(width, policy.chunk_bytes / sizeof(T) / width * width);
+    std::size_t const chunks = (n + chunk - 1) / chunk;
+
+    auto const split = [&](auto& out, auto const& in) {
+        policy.pool.run([&](std::size_t worker){
+            for (std::size_t c = worker; c < chunks; c += threads) {
+                evaluate<T>(out, in, c * chunk, std::min(n, (c + 1) * chunk));
+            }
+        });
+    };
+
+    // (the scratch array is filled and copied back in the same chunks - see expr_alias.hpp)
+    if (assignment_aliasing(dst, src, n) == Aliasing::overlap) {
+        SArray<T> scratch{n, uninitialized};
+        split(scratch, src);
+        split(dst, scratch);
+    }
+    else {
+        split(dst, src);
+    }
+}
+
+// Parallel counterpart of Array::operator=.
+// The index range is split into fixed chunks which are dealt out round-robin to the
+// workers (chunk c is always evaluated by worker c % pool.size()), so that the work
+// assignment - and therefore the result - does not depend on thread timing.
+// The chunks write disjoint parts of the destination, so no synchronization is necessary
+// beyond waiting for all chunks to finish - provided no chunk reads what another one writes:
+// only a source which reads the destination at the element being written (x = 2.0*x + y), if
+// at all, is evaluated in place; one which reads it at other indices (shift, slice, stencil,
+// x[y], a view of a part of it) goes through a scratch array.
+template<typename T, typename Rep, typename T2, typename Rep2>
+void parallel_assign(Array<T,Rep>& dst, Array<T2,Rep2> const& src, ParallelPolicy const& policy)
+{
+    assert(dst.size() == src.size());
+    std::size_t const n = src.size();
+
+    // A subscripted destination (x[y] = ...) may write the same element from two chunks,
+    // so it is never split between threads; nor is a sparse one, which is built anew
+    // over the support of the source (see eval_sparse).
+    if constexpr (is_subscript_v<Rep> || is_sparse_rep_v<Rep>) {
+        dst = src;
+    }
+    else if (policy.pool.size() == 1 || n < policy.threshold) {
+        dst = src;
+    }
+    else {
+        parallel_chunks<T>(dst.rep(), src.rep(), n, policy);
+    }
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include "expr_array.hpp"
+#include "expr_eval.hpp"
+#include "expr_alias.hpp"
+
+// Several assignments evaluated together, one tile of the index range at a time:
+//   pipeline(assign(a, x*y), assign(b, a + z), assign(c, b*x)).run();
+// computes the same as
+//   a = x*y; b = a + z; c = b*x;
+// but instead of three passes over whole arrays it evaluates all three statements for
+// the first tile, then for the second tile and so on. With tiles sized to fit in the L2 cache
+// a and b are still cached when the later statements read them, so each array travels
+// between memory and cache once instead of once per statement.
+//
+// This relies on every statement being elementwise - element i of a statement only depends
+// on element i of the earlier results. Statements that gather or scatter (x[y]), or read
+// their operands at other indices (shift, slice, stencil), may read elements of another tile,
+// so a pipeline containing one is evaluated statement by statement. So is a pipeline in which
+// a statement reads the destination of any statement at other indices (through a view of a
+// part of it). A statement evaluated as a whole is checked for aliasing like an assignment.
+//
+// Like an Array expression, a pipeline refers to the temporaries of the full-expression
+// creating it, so it has to be run within that full-expression.
+
+
+// how large the tiles are
+struct TilePolicy
+{
+    std::size_t tile_bytes{256u * 1024u};   // bytes of all arrays touched by one tile, ~ L2
+};
+
+
+// number of arrays an expression reads (an upper bound - an array read twice counts twice)
+/* --------------------------------------------------------------------------------------------- */
+template<typename E>
+struct leaf_count : std::integral_constant<std::size_t, 1> { };
+
+template<typename T>
+struct leaf_count<A_Scalar<T>> : std::integral_constant<std::size_t, 0> { };
+
+template<typename T, typename OP1, typename OP2>
+struct leaf_count<A_Add<T,OP1,OP2>>
+    : std::integral_constant<std::size_t, leaf_count<OP1>::value + leaf_count<OP2>::value> { };
+
+template<typename T, typename OP1, typename OP2>
+struct leaf_count<A_Mult<T,OP1,OP2>>
+    : std::integral_constant<std::size_t, leaf_count<OP1>::value + leaf_count<OP2>::value> { };
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+struct leaf_count<A_FMA<T,OP1,OP2,OP3>>
+    : std::integral_constant<std::size_t, leaf_count<OP1>::value + leaf_count<OP2>::value
+                                          + leaf_count<OP3>::value> { };
+
+template<typename T, typename OP1, typename OP2, typename Op>
+struct leaf_count<A_Binary<T,OP1,OP2,Op>>
+    : std::integral_constant<std::size_t, leaf_count<OP1>::value + leaf_count<OP2>::value> { };
+
+template<typename T, typename OP, typename Op>
+struct leaf_count<A_Unary<T,OP,Op>> : leaf_count<OP> { };
+
+template<typename T, typename OP1, typename OP2, typename Cmp>
+struct leaf_count<A_Compare<T,OP1,OP2,Cmp>>
+    : std::integral_constant<std::size_t, leaf_count<OP1>::value + leaf_count<OP2>::value> { };
+
+template<typename T, typename M, typename OP1, typename OP2>
+struct leaf_count<A_Where<T,M,OP1,OP2>>
+    : std::integral_constant<std::size_t, leaf_count<M>::value + leaf_count<OP1>::value
+                                          + leaf_count<OP2>::value> { };
+
+template<typename T, typename OP>
+struct leaf_count<A_Convert<T,OP>> : leaf_count<OP> { };
+
+template<typename T, typename OP, typename Boundary>
+struct leaf_count<A_Shift<T,OP,Boundary>> : leaf_count<OP> { };
+
+template<typename T, typename OP>
+struct leaf_count<A_Slice<T,OP>> : leaf_count<OP> { };
+
+template<typename T, typename OP, typename Boundary, std::size_t N>
+struct leaf_count<A_Stencil<T,OP,Boundary,N>> : leaf_count<OP> { };
+
+template<typename T, typename A1, typename A2>
+struct leaf_count<A_Subscript<T,A1,A2>>
+    : std::integral_constant<std::size_t, leaf_count<A1>::value + leaf_count<A2>::value> { };
+
+template<typename E>
+constexpr inline std::size_t leaf_count_v = leaf_count<E>::value;
+/* --------------------------------------------------------------------------------------------- */
+
+
+// one statement of a pipeline: dst = src
+template<typename T, typename Rep, typename Src>
+class Assignment
+{
+public:
+    // can the statement be evaluated for a part of the index range, interleaved with others
+    static constexpr bool tileable = !is_subscript_v<Rep> && !has_subscript_v<Src>
+                                     && all_elementwise<Src>();
+    // bytes of the arrays read and written per element
+    static constexpr std::size_t bytes_per_element = sizeof(T) * (1 + leaf_count_v<Src>);
+
+    Assignment(Array<T,Rep>& dst, Src const& src)
+        : dst_{dst}, src_{src} { }
+
+    std::size_t size() const { return dst_.size(); }
+
+    // how the source reads the destination of a statement (this one, or another)
+    template<typename Stage>
+    Aliasing reads(Stage const& stage) const
+    {
+        return assignment_aliasing(stage.destination(), src_, stage.size());
+    }
+
+    Rep const& destination() const { return dst_.rep(); }
+
+    // evaluate [first, last) - the whole range like Array::operator=, through a scratch array
+    // if the source overlaps the destination (see expr_alias.hpp)
+    void run(std::size_t first, std::size_t last) const
+    {
+        if (first == 0 && last == size()) {
+            evaluate_assignment<T>(dst_.rep(), src_, size());
+        }
+        else {
+            evaluate<T>(dst_.rep(), src_, first, last);
+        }
+    }
+
+private:
+    Array<T,Rep>& dst_;
+    typename A_Traits<Src>::ExprRef src_;
+};
+
+template<typename T, typename Rep, typename T2, typename Rep2>
+Assignment<T,Rep,Rep2> assign(Array<T,Rep>& dst, Array<T2,Rep2> const& src)
+{
+    assert(dst.size() == src.size());
+    return Assignment<T,Rep,Rep2>{dst, src.rep()};
+}
+
+
+template<typename... Stages>
+class Pipeline
+{
+    static_assert(sizeof...(Stages) > 0, "Pipeline: no statements");
+
+public:
+    static constexpr bool tileable = (Stages::tileable && ...);
+    static constexpr std::size_t bytes_per_element = (Stages::bytes_per_element + ...);
+
+    explicit Pipeline(Stages const&... stages)
+        : stages_{stages...} { }
+
+    // number of elements per tile - a multiple of 64, so that every packet width divides it
+    // and only the very last tile runs scalar tails
+    static std::size_t tile_size(TilePolicy const& policy)
+    {
+        return std::max<std::size_t>(64, policy.tile_bytes / bytes_per_element / 64 * 64);
+    }
+
+    void run(TilePolicy const& policy = TilePolicy{}) const
+    {
+        std::size_t const n = std::get<0>(stages_).size();
+        assert(std::apply([n](auto const&... stage){ return ((stage.size() == n) && ...); },
+                          stages_));
+
+        std::size_t const tile = tileable && !overlapping() ? tile_size(policy) : n;
+        for (std::size_t first = 0; first < n; first += tile) {
+            std::size_t const last = std::min(n, first + tile);
+            std::apply([first, last](auto const&... stage){
+                (stage.run(first, last), ...);
+            }, stages_);
+        }
+    }
+
+private:
+    // does a statement read the destination of one of them at other indices (through a view
+    // of a part of it) - it may then read elements of another tile
+    bool overlapping() const
+    {
+        auto const overlaps = [this](auto const& stage) {
+            return std::apply([&stage](auto const&... other){
+                return ((stage.reads(other) == Aliasing::overlap) || ...);
+            }, stages_);
+        };
+        return std::apply([&overlaps](auto const&... stage){
+            return (overlaps(stage) || ...);
+        }, stages_);
+    }
+
+    std::tuple<Stages...> stages_;
+};
+
+template<typename... Stages>
+Pipeline<Stages...> pipeline(Stages const&... stages)
+{
+    return Pipeline<Stages...>{stages...};
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "expr_packet.hpp"
+
+// Reductions that consume an expression template directly.
+// The expression tree is walked once, index by index (or packet by packet), so e.g.
+//   sum(1.2*x + x*y)
+// never materializes the intermediate array.
+//
+// Several independent accumulators are used, so that consecutive additions do not wait on
+// each other and the loop is limited by throughput rather than by the latency of a
+// single dependency chain. Note that this reassociates the sum - the result may differ from
+// a strictly sequential loop in the last bits.
+
+
+// reduction operations: how to combine two values or two packets
+template<typename T>
+struct ReduceSum
+{
+    static T combine(T a, T b) { return a + b; }
+    static typename Packet<T>::type combine_packet(typename Packet<T>::type a,
+                                                   typename Packet<T>::type b)
+    {
+        return Packet<T>::add(a, b);
+    }
+};
+
+template<typename T>
+struct ReduceMin
+{
+    static T combine(T a, T b) { return b < a ? b : a; }
+    static typename Packet<T>::type combine_packet(typename Packet<T>::type a,
+                                                   typename Packet<T>::type b)
+    {
+        return Packet<T>::min(a, b);
+    }
+};
+
+template<typename T>
+struct ReduceMax
+{
+    static T combine(T a, T b) { return a < b ? b : a; }
+    static typename Packet<T>::type combine_packet(typename Packet<T>::type a,
+                                                   typename Packet<T>::type b)
+    {
+        return Packet<T>::max(a, b);
+    }
+};
+
+
+// the number of independent accumulators
+constexpr inline std::size_t reduce_accumulators = 4;
+
+// fully unrolled reduction of an expression with a small compile-time size (see unroll_limit)
+template<typename Op, typename T, typename Rep, std::size_t... Idx>
+T reduce_unrolled(Rep const& expr, T init, std::index_sequence<Idx...>)
+{
+    T result = init;
+    ((result = Op::combine(result, expr[Idx])), ...);
+    return result;
+}
+
+// Reduce [0, size()) of the expression with Op, starting from init.
+// For min/max init has to be an element of the expression (min(x, x) == x).
+template<typename Op, typename T, typename Rep>
+T reduce(Array<T,Rep> const& a, T init)
+{
+    Rep const& expr = a.rep();
+    std::size_t const n = a.size();
+    constexpr std::size_t k = reduce_accumulators;
+    std::size_t idx = 0;
+    T result = init;
+
+    if constexpr (static_size_v<Rep> != 0 && static_size_v<Rep> <= unroll_limit) {
+        return reduce_unrolled<Op>(expr, init, std::make_index_sequence<static_size_v<Rep>>{});
+    }
+    else if constexpr (has_packet_v<T> && is_packet_accessible_v<Rep,T>) {
+        using P = Packet<T>;
+        constexpr std::size_t width = P::size;
+
+        typename P::type acc[k];
+        for (auto& p : acc) {
+            p = P::broadcast(init);
+        }
+        for (; n - idx >= k * width; idx += k * width) {
+            for (std::size_t j = 0; j < k; ++j) {
+                acc[j] = Op::combine_packet(acc[j], expr.load_packet(idx + j * width));
+            }
+        }
+        for (; n - idx >= width; idx += width) {
+            acc[0] = Op::combine_packet(acc[0], expr.load_packet(idx));
+        }
+        for (std::size_t j = 1; j < k; ++j) {
+            acc[0] = Op::combine_packet(acc[0], acc[j]);
+        }
+
+        // horizontal reduction of the lanes
+        alignas(sizeof(typename P::type)) T lanes[width];
+        P::store(lanes, acc[0]);
+        for (T lane : lanes) {
+            result = Op::combine(result, lane);
+        }
+    }
+    else {
+        T acc[k];
+        for (auto& s : acc) {
+            s = init;
+        }
+        for (; n - idx >= k; idx += k) {
+            for (std::size_t j = 0; j < k; ++j) {
+                acc[j] = Op::combine(acc[j], expr[idx + j]);
+            }
+        }
+        for (T s : acc) {
+            result = Op::combine(result, s);
+        }
+    }
+
+    // scalar tail
+    for (; idx < n; ++idx) {
+        result = Op::combine(result, expr[idx]);
+    }
+    return result;
+}
+
+
+// sum of all elements
+template<typename T, typename Rep>
+T sum(Array<T,Rep> const& a)
+{
+    return reduce<ReduceSum<T>>(a, T{});
+}
+
+// smallest element; the array must not be empty
+template<typename T, typename Rep>
+T min(Array<T,Rep> const& a)
+{
+    assert(a.size() > 0);
+    return reduce<ReduceMin<T>>(a, T(a[0]));
+}
+
+// largest element; the array must not be empty
+template<typename T, typename Rep>
+T max(Array<T,Rep> const& a)
+{
+    assert(a.size() > 0);
+    return reduce<ReduceMax<T>>(a, T(a[0]));
+}
+
+// inner product - the product is fused into the sum, no temporary array
+template<typename T, typename R1, typename R2>
+T dot(Array<T,R1> const& a, Array<T,R2> const& b)
+{
+    return sum(a * b);
+}
+
+// euclidean norm
+template<typename T, typename Rep>
+T norm2(Array<T,Rep> const& a)
+{
+    using std::sqrt;
+    return sqrt(dot(a, a));
+}
+
+
+// Kahan (compensated) summation.
+// Each packet lane carries its own compensation term; the partial sums of the lanes
+// are combined with compensation as well. The error is then independent of the array size,
+// at the price of four floating point operations per element instead of one.
+// Don't compile with -ffast-math, which is allowed to optimize the compensation away.
+struct kahan_t { };
+constexpr inline kahan_t kahan{};
+
+template<typename T>
+struct KahanSum
+{
+    T sum{};
+    T compensation{};
+
+    void add(T value)
+    {
+        T const y = value - compensation;
+        T const t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
+    }
+};
+
+template<typename T, typename Rep>
+T sum(Array<T,Rep> const& a, kahan_t)
+{
+    Rep const& expr = a.rep();
+    std::size_t const n = a.size();
+    std::size_t idx = 0;
+    KahanSum<T> result;
+
+    if constexpr (has_packet_v<T> && is_packet_accessible_v<Rep,T>) {
+        using P = Packet<T>;
+        constexpr std::size_t width = P::size;
+
+        auto s = P::broadcast(T{});
+        auto c = P::broadcast(T{});
+        for (; n - idx >= width; idx += width) {
+            auto const y = P::sub(expr.load_packet(idx), c);
+            auto const t = P::add(s, y);
+            c = P::sub(P::sub(t, s), y);
+            s = t;
+        }
+
+        alignas(sizeof(typename P::type)) T sums[width];
+        alignas(sizeof(typename P::type)) T compensations[width];
+        P::store(sums, s);
+        P::store(compensations, c);
+        for (std::size_t lane = 0; lane < width; ++lane) {
+            result.add(sums[lane]);
+            result.add(-compensations[lane]);
+        }
+    }
+
+    for (; idx < n; ++idx) {
+        result.add(expr[idx]);
+    }
+    return result.sum;
+}
+
+template<typename T, typename R1, typename R2>
+T dot(Array<T,R1> const& a, Array<T,R2> const& b, kahan_t)
+{
+    return sum(a * b, kahan);
+}
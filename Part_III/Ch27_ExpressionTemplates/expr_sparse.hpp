@@ -0,0 +1,428 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include "expr_fwd.hpp"
+#include "expr_types.hpp"
+
+// Evaluation of assignments involving sparse representations - arrays which store only some
+// of their elements and treat the others as zero, like SparseArray and RleArray of
+// sparse_array.hpp. A sparse representation declares `static constexpr bool sparse = true;`,
+// and a destination of that kind provides
+//   Rep{n}                     - an array of n zeros
+//   append(first, last, value) - elements [first, last) have the value (in increasing order)
+// An expression is visited through a cursor (sparse_cursor(e, n) below), which knows its
+// support - the index ranges outside of which the expression is zero - and reads the values
+// in increasing index order:
+//   sparse        - the support is not simply [0, n)
+//   next(r)       - the next range of the support, false after the last
+//   at(idx)       - the value at idx, idx must not decrease from call to call
+//   run_end(idx)  - after at(idx): the value stays the same up to run_end(idx)
+// The support propagates through the nodes: a product is zero where either operand is, so
+// its support is the intersection of the supports of the operands (or just that of the
+// sparse one); a sum, a difference, min and max are zero where both operands are - the union,
+// merged from the two sorted range lists. Unary operations which keep zero (-a, abs, sqrt)
+// keep the support. An assignment whose right-hand side has a sparse support (or whose
+// destination is sparse) visits only the support, a run of equal values at a time,
+// so the time is proportional to the number of nonzeros (or runs) rather than the size.
+// Structural zeros are exact zeros: 0 * inf is taken to be 0.
+
+struct IndexRange
+{
+    std::size_t first;
+    std::size_t last;
+};
+
+template<typename E, typename = std::void_t<>>
+struct is_sparse_rep : std::false_type { };
+
+template<typename E>
+struct is_sparse_rep<E, std::void_t<decltype(E::sparse)>> : std::bool_constant<E::sparse> { };
+
+template<typename E>
+constexpr inline bool is_sparse_rep_v = is_sparse_rep<E>::value;
+
+
+// Cursors
+/* --------------------------------------------------------------------------------------------- */
+// any expression, through its subscript operator: the support is all of [0, n)
+template<typename E>
+class DenseCursor
+{
+public:
+    using value_type = typename E::value_type;
+    static constexpr bool sparse = false;
+
+    DenseCursor(E const& e, std::size_t n)
+        : e_{e}, n_{n}, done_{false} { }
+
+    bool next(IndexRange& r) {
+        if (done_ || n_ == 0) {
+            return false;
+        }
+        done_ = true;
+        r = IndexRange{0, n_};
+        return true;
+    }
+
+    value_type at(std::size_t idx) const { return e_[idx]; }
+
+    std::size_t run_end(std::size_t idx) const { return idx + 1; }
+
+private:
+    E const& e_;
+    std::size_t n_;
+    bool done_;
+};
+
+// a scalar - the same value everywhere
+template<typename T>
+class ScalarCursor
+{
+public:
+    using value_type = T;
+    static constexpr bool sparse = false;
+
+    ScalarCursor(A_Scalar<T> const& s, std::size_t n)
+        : value_{s.value()}, n_{n}, done_{false} { }
+
+    bool next(IndexRange& r) {
+        if (done_ || n_ == 0) {
+            return false;
+        }
+        done_ = true;
+        r = IndexRange{0, n_};
+        return true;
+    }
+
+    T at(std::size_t) const { return value_; }
+
+    std::size_t run_end(std::size_t) const { return n_; }
+
+private:
+    T value_;
+    std::size_t n_;
+    bool done_;
+};
+
+// the elementwise operation of two cursors, zero where either is zero (a*b)
+template<typename T, typename CA, typename CB, typename Op>
+class IntersectionCursor
+{
+public:
+    using value_type = T;
+    static constexpr bool sparse = CA::sparse || CB::sparse;
+
+    IntersectionCursor(CA a, CB b, std::size_t n)
+        : a_{std::move(a)}, b_{std::move(b)}, ra_{}, rb_{}, has_a_{false}, has_b_{false},
+          started_{false}, n_{n}
+        { }
+
+    bool next(IndexRange& r) {
+        if constexpr (CA::sparse && CB::sparse) {
+            if (!started_) {
+                started_ = true;
+                has_a_ = a_.next(ra_);
+                has_b_ = b_.next(rb_);
+            }
+            while (has_a_ && has_b_) {
+                IndexRange const common{std::max(ra_.first, rb_.first),
+                                        std::min(ra_.last, rb_.last)};
+                // (the range which ends first can not overlap any later one of the other)
+                if (ra_.last <= rb_.last) {
+                    has_a_ = a_.next(ra_);
+                }
+                else {
+                    has_b_ = b_.next(rb_);
+                }
+                if (common.first < common.last) {
+                    r = common;
+                    return true;
+                }
+            }
+            return false;
+        }
+        else if constexpr (CA::sparse) {
+            return a_.next(r);
+        }
+        else if constexpr (CB::sparse) {
+            return b_.next(r);
+        }
+        else {
+            if (started_ || n_ == 0) {
+                return false;
+            }
+            started_ = true;
+            r = IndexRange{0, n_};
+            return true;
+        }
+    }
+
+    T at(std::size_t idx) {
+        return Op::template apply<T>(a_.at(idx), b_.at(idx));
+    }
+
+    std::size_t run_end(std::size_t idx) const {
+        return std::min(a_.run_end(idx), b_.run_end(idx));
+    }
+
+private:
+    CA a_;
+    CB b_;
+    IndexRange ra_, rb_;    // the current range of each support
+    bool has_a_, has_b_;
+    bool started_;
+    std::size_t n_;
+};
+
+// the elementwise operation of two cursors, zero where both are zero (a+b, a-b, min, max)
+template<typename T, typename CA, typename CB, typename Op>
+class UnionCursor
+{
+public:
+    using value_type = T;
+    static constexpr bool sparse = CA::sparse && CB::sparse;
+
+    UnionCursor(CA a, CB b, std::size_t n)
+        : a_{std::move(a)}, b_{std::move(b)}, ra_{}, rb_{}, has_a_{false}, has_b_{false},
+          started_{false}, n_{n}
+        { }
+
+    bool next(IndexRange& r) {
+        if constexpr (sparse) {
+            if (!started_) {
+                started_ = true;
+                has_a_ = a_.next(ra_);
+                has_b_ = b_.next(rb_);
+            }
+            if (!has_a_ && !has_b_) {
+                return false;
+            }
+            // merge join: start with the range which starts first, then take in every range
+            // of either support which overlaps or touches it
+            if (has_a_ && (!has_b_ || ra_.first <= rb_.first)) {
+                r = ra_;
+                has_a_ = a_.next(ra_);
+            }
+            else {
+                r = rb_;
+                has_b_ = b_.next(rb_);
+            }
+            for (bool merged = true; merged; ) {
+                merged = false;
+                if (has_a_ && ra_.first <= r.last) {
+                    r.last = std::max(r.last, ra_.last);
+                    has_a_ = a_.next(ra_);
+                    merged = true;
+                }
+                if (has_b_ && rb_.first <= r.last) {
+                    r.last = std::max(r.last, rb_.last);
+                    has_b_ = b_.next(rb_);
+                    merged = true;
+                }
+            }
+            return true;
+        }
+        else {
+            if (started_ || n_ == 0) {
+                return false;
+            }
+            started_ = true;
+            r = IndexRange{0, n_};
+            return true;
+        }
+    }
+
+    T at(std::size_t idx) {
+        return Op::template apply<T>(a_.at(idx), b_.at(idx));
+    }
+
+    std::size_t run_end(std::size_t idx) const {
+        return std::min(a_.run_end(idx), b_.run_end(idx));
+    }
+
+private:
+    CA a_;
+    CB b_;
+    IndexRange ra_, rb_;
+    bool has_a_, has_b_;
+    bool started_;
+    std::size_t n_;
+};
+
+// an elementwise operation which maps zero to zero (-a, abs, sqrt)
+template<typename T, typename C, typename Op>
+class UnaryCursor
+{
+public:
+    using value_type = T;
+    static constexpr bool sparse = C::sparse;
+
+    explicit UnaryCursor(C c)
+        : c_{std::move(c)} { }
+
+    bool next(IndexRange& r) { return c_.next(r); }
+
+    T at(std::size_t idx) { return Op::template apply<T>(c_.at(idx)); }
+
+    std::size_t run_end(std::size_t idx) const { return c_.run_end(idx); }
+
+private:
+    C c_;
+};
+/* --------------------------------------------------------------------------------------------- */
+
+
+// the operations of A_Add and A_Mult, in the form of those of A_Binary
+struct SparseAdd {
+    template<typename T> static T apply(T a, T b) { return a + b; }
+};
+
+struct SparseMul {
+    template<typename T> static T apply(T a, T b) { return a * b; }
+};
+
+// binary operations which are zero where both operands are: their support is the union
+template<typename Op>
+struct is_zero_union_op : std::false_type { };
+template<> struct is_zero_union_op<OpSub> : std::true_type { };
+template<> struct is_zero_union_op<OpMin> : std::true_type { };
+template<> struct is_zero_union_op<OpMax> : std::true_type { };
+
+// unary operations which map zero to zero
+template<typename Op>
+struct is_zero_preserving_op : std::false_type { };
+template<> struct is_zero_preserving_op<OpNeg> : std::true_type { };
+template<> struct is_zero_preserving_op<OpAbs> : std::true_type { };
+template<> struct is_zero_preserving_op<OpSqrt> : std::true_type { };
+
+
+// sparse_cursor(e, n) - the cursor of an expression of n elements
+// (the sparse representations add theirs, see sparse_array.hpp)
+/* --------------------------------------------------------------------------------------------- */
+template<typename E>
+DenseCursor<E> sparse_cursor(E const& e, std::size_t n)
+{
+    return DenseCursor<E>{e, n};
+}
+
+template<typename T>
+ScalarCursor<T> sparse_cursor(A_Scalar<T> const& s, std::size_t n)
+{
+    return ScalarCursor<T>{s, n};
+}
+
+template<typename T, typename OP1, typename OP2>
+auto sparse_cursor(A_Mult<T,OP1,OP2> const& e, std::size_t n)
+{
+    auto a = sparse_cursor(e.first(), n);
+    auto b = sparse_cursor(e.second(), n);
+    return IntersectionCursor<T, decltype(a), decltype(b), SparseMul>{std::move(a), std::move(b), n};
+}
+
+template<typename T, typename OP1, typename OP2>
+auto sparse_cursor(A_Add<T,OP1,OP2> const& e, std::size_t n)
+{
+    auto a = sparse_cursor(e.first(), n);
+    auto b = sparse_cursor(e.second(), n);
+    return UnionCursor<T, decltype(a), decltype(b), SparseAdd>{std::move(a), std::move(b), n};
+}
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+auto sparse_cursor(A_FMA<T,OP1,OP2,OP3> const& e, std::size_t n)
+{
+    auto a = sparse_cursor(e.first(), n);
+    auto b = sparse_cursor(e.second(), n);
+    using Product = IntersectionCursor<T, decltype(a), decltype(b), SparseMul>;
+    auto c = sparse_cursor(e.third(), n);
+    return UnionCursor<T, Product, decltype(c), SparseAdd>{
+        Product{std::move(a), std::move(b), n}, std::move(c), n};
+}
+
+template<typename T, typename OP1, typename OP2, typename Op>
+auto sparse_cursor(A_Binary<T,OP1,OP2,Op> const& e, std::size_t n)
+{
+    if constexpr (is_zero_union_op<Op>::value) {
+        auto a = sparse_cursor(e.first(), n);
+        auto b = sparse_cursor(e.second(), n);
+        return UnionCursor<T, decltype(a), decltype(b), Op>{std::move(a), std::move(b), n};
+    }
+    else {
+        return DenseCursor<A_Binary<T,OP1,OP2,Op>>{e, n};
+    }
+}
+
+template<typename T, typename OP, typename Op>
+auto sparse_cursor(A_Unary<T,OP,Op> const& e, std::size_t n)
+{
+    if constexpr (is_zero_preserving_op<Op>::value) {
+        auto c = sparse_cursor(e.first(), n);
+        return UnaryCursor<T, decltype(c), Op>{std::move(c)};
+    }
+    else {
+        return DenseCursor<A_Unary<T,OP,Op>>{e, n};
+    }
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// is the support of the expression E smaller than all of its elements
+template<typename E>
+constexpr inline bool has_sparse_support_v =
+    decltype(sparse_cursor(std::declval<E const&>(), std::size_t{}))::sparse;
+
+
+// dst = src for [0, n), visiting only the support of src
+template<typename T, typename Dst, typename Src>
+void eval_sparse(Dst& dst, Src const& src, std::size_t n)
+{
+    auto cursor = sparse_cursor(src, n);
+    using V = typename decltype(cursor)::value_type;
+    auto const convert = [](V v) -> T {
+        if constexpr (std::is_same_v<T, V>) {
+            return v;
+        }
+        else {
+            return static_cast<T>(v);
+        }
+    };
+
+    // every run of equal values of the support: f(first, last, value)
+    auto const for_each_run = [&](auto f) {
+        IndexRange r{};
+        while (cursor.next(r)) {
+            for (std::size_t idx = r.first; idx < r.last; ) {
+                T const value = convert(cursor.at(idx));
+                std::size_t const end = std::min(cursor.run_end(idx), r.last);
+                f(idx, end, value);
+                idx = end;
+            }
+        }
+    };
+
+    if constexpr (is_sparse_rep_v<Dst>) {
+        // built apart and then moved in, as src may read dst
+        Dst result{n};
+        for_each_run([&](std::size_t first, std::size_t last, T value) {
+            result.append(first, last, value);
+        });
+        dst = std::move(result);
+    }
+    else {
+        // (in order, so that writing an element never precedes reading it)
+        std::size_t done = 0;
+        for_each_run([&](std::size_t first, std::size_t last, T value) {
+            for (; done < first; ++done) {
+                dst[done] = T{};
+            }
+            for (; done < last; ++done) {
+                dst[done] = value;
+            }
+        });
+        for (; done < n; ++done) {
+            dst[done] = T{};
+        }
+    }
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <array>
+#include <type_traits>
+#include "expr_array.hpp"
+#include "expr_types.hpp"
+
+// Nodes which read their operand at other indices than their own, for 1-D convolutions:
+//   y = 0.25*shift(x, -1) + 0.5*x + 0.25*shift(x, 1);         // y[i] = .25 x[i-1] + ...
+//   y = stencil(x, {0.25, 0.5, 0.25});                        // the same, as one node
+//   y = slice(x, 1, n/2, 2) - slice(x, 0, n/2, 2);            // like std::slice
+// Elements before the first or after the last one of the operand are given by a boundary
+// policy: boundary_zero (zero), boundary_clamp (the first / last element) or boundary_wrap
+// (periodic). All of them stay in the one evaluation loop of the assignment. A packet of a
+// shift or stencil is loaded from the operand at the shifted index - unaligned loads of
+// elements which are in the L1 cache from the previous packets - and only the packets which
+// reach across the boundary are assembled element by element.
+
+
+// Boundary policies - the element j of op, for j outside [0, op.size())
+/* --------------------------------------------------------------------------------------------- */
+struct BoundaryZero {
+    template<typename T, typename OP>
+    static T outside(OP const&, std::ptrdiff_t) { return T{}; }
+};
+
+struct BoundaryClamp {
+    template<typename T, typename OP>
+    static T outside(OP const& op, std::ptrdiff_t j) {
+        return op[j < 0 ? 0 : op.size() - 1];
+    }
+};
+
+struct BoundaryWrap {
+    template<typename T, typename OP>
+    static T outside(OP const& op, std::ptrdiff_t j) {
+        auto const n = static_cast<std::ptrdiff_t>(op.size());
+        return op[static_cast<std::size_t>((j % n + n) % n)];
+    }
+};
+
+constexpr inline BoundaryZero boundary_zero{};
+constexpr inline BoundaryClamp boundary_clamp{};
+constexpr inline BoundaryWrap boundary_wrap{};
+
+// element j of op, with the Boundary outside of it
+template<typename T, typename Boundary, typename OP>
+T element_at(OP const& op, std::ptrdiff_t j)
+{
+    if (j >= 0 && static_cast<std::size_t>(j) < op.size()) {
+        return op[static_cast<std::size_t>(j)];
+    }
+    return Boundary::template outside<T>(op, j);
+}
+
+// a packet of elements idx... of e, one at a time (for packets across a boundary)
+template<typename T, typename E>
+typename Packet<T>::type assemble_packet(E const& e, std::size_t idx)
+{
+    alignas(64) T lanes[Packet<T>::size];
+    for (std::size_t k = 0; k < Packet<T>::size; ++k) {
+        lanes[k] = e[idx + k];
+    }
+    return Packet<T>::load(lanes);
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// class for objects that represent the operand shifted by offset: element idx is op[idx + offset]
+template<typename T, typename OP, typename Boundary>
+class A_Shift {
+private:
+    typename A_Traits<OP>::ExprRef op;
+    std::ptrdiff_t offset_;
+
+public:
+    using value_type = T;
+    static constexpr bool packet_access = is_packet_accessible_v<OP,T>;
+
+    A_Shift(OP const& a, std::ptrdiff_t offset)
+        : op{a}, offset_{offset} { }
+
+    T operator[] (std::size_t idx) const {
+        return element_at<T, Boundary>(op, static_cast<std::ptrdiff_t>(idx) + offset_);
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        std::ptrdiff_t const j = static_cast<std::ptrdiff_t>(idx) + offset_;
+        if (j >= 0 && static_cast<std::size_t>(j) + Packet<T>::size <= op.size()) {
+            return op.load_packet(static_cast<std::size_t>(j));
+        }
+        return assemble_packet<T>(*this, idx);
+    }
+
+    OP const& first() const { return op; }
+    std::ptrdiff_t offset() const { return offset_; }
+
+    std::size_t size() const { return op.size(); }
+};
+
+// class for objects that represent every step-th element of the operand, from start on
+// (step may be negative): element idx is op[start + idx*step]
+template<typename T, typename OP>
+class A_Slice {
+private:
+    typename A_Traits<OP>::ExprRef op;
+    std::size_t start_;
+    std::size_t size_;
+    std::ptrdiff_t step_;
+
+public:
+    using value_type = T;
+    // (packets are assembled element by element, so that the rest of the expression
+    // can still be evaluated a packet at a time)
+    static constexpr bool packet_access = true;
+
+    A_Slice(OP const& a, std::size_t start, std::size_t size, std::ptrdiff_t step)
+        : op{a}, start_{start}, size_{size}, step_{step}
+        {
+            assert(size == 0 || index(size - 1) < a.size());
+        }
+
+    T operator[] (std::size_t idx) const {
+        return op[index(idx)];
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return assemble_packet<T>(*this, idx);
+    }
+
+    OP const& first() const { return op; }
+    std::size_t start() const { return start_; }
+    std::ptrdiff_t step() const { return step_; }
+
+    std::size_t size() const { return size_; }
+
+private:
+    std::size_t index(std::size_t idx) const {
+        return static_cast<std::size_t>(static_cast<std::ptrdiff_t>(start_)
+                                        + static_cast<std::ptrdiff_t>(idx) * step_);
+    }
+};
+
+// class for objects that represent the weighted sum of N neighbours of each element:
+// element idx is the sum of weights[k] * op[idx + origin + k]
+template<typename T, typename OP, typename Boundary, std::size_t N>
+class A_Stencil {
+private:
+    typename A_Traits<OP>::ExprRef op;
+    std::array<T, N> weights_;
+    typename Packet<T>::type packets_[N];   // the weights, broadcast
+    std::ptrdiff_t origin_;
+    std::size_t interior_first_;            // the packets which read no element outside op
+    std::size_t interior_count_;
+
+public:
+    using value_type = T;
+    static constexpr bool packet_access = is_packet_accessible_v<OP,T>;
+
+    A_Stencil(OP const& a, std::array<T, N> const& weights, std::ptrdiff_t origin)
+        : op{a}, weights_{weights}, packets_{}, origin_{origin}, interior_first_{0},
+          interior_count_{0}
+        {
+            for (std::size_t k = 0; k < N; ++k) {
+                packets_[k] = Packet<T>::broadcast(weights[k]);
+            }
+            std::ptrdiff_t const lo = origin < 0 ? -origin : 0;
+            std::ptrdiff_t const hi = static_cast<std::ptrdiff_t>(a.size()) - origin
+                                      - static_cast<std::ptrdiff_t>(N - 1 + Packet<T>::size);
+            if (hi >= lo) {
+                interior_first_ = static_cast<std::size_t>(lo);
+                interior_count_ = static_cast<std::size_t>(hi - lo + 1);
+            }
+        }
+
+    T operator[] (std::size_t idx) const {
+        std::ptrdiff_t const j = static_cast<std::ptrdiff_t>(idx) + origin_;
+        if (j >= 0 && static_cast<std::size_t>(j) + N <= op.size()) {
+            auto const first = static_cast<std::size_t>(j);
+            T sum = weights_[0] * op[first];
+            for (std::size_t k = 1; k < N; ++k) {
+                sum += weights_[k] * op[first + k];
+            }
+            return sum;
+        }
+        T sum = weights_[0] * element_at<T, Boundary>(op, j);
+        for (std::size_t k = 1; k < N; ++k) {
+            sum += weights_[k] * element_at<T, Boundary>(op, j + static_cast<std::ptrdiff_t>(k));
+        }
+        return sum;
+    }
+
+    // one boundary test for all the taps, against the range of packets computed once by the
+    // constructor, like the broadcast weights
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        using P = Packet<T>;
+        if (idx - interior_first_ < interior_count_) {
+            auto const first = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(idx) + origin_);
+            auto sum = P::mul(packets_[0], op.load_packet(first));
+            for (std::size_t k = 1; k < N; ++k) {
+                sum = P::fmadd(packets_[k], op.load_packet(first + k), sum);
+            }
+            return sum;
+        }
+        return assemble_packet<T>(*this, idx);
+    }
+
+    OP const& first() const { return op; }
+    std::array<T, N> const& weights() const { return weights_; }
+    std::ptrdiff_t origin() const { return origin_; }
+
+    std::size_t size() const { return op.size(); }
+};
+
+
+// shift(a, offset) - element i is a[i + offset]
+template<typename T, typename R, typename Boundary = BoundaryZero>
+Array<T, A_Shift<T,R,Boundary>> shift(Array<T,R> const& a, std::ptrdiff_t offset,
+                                      Boundary = Boundary{})
+{
+    return Array<T, A_Shift<T,R,Boundary>>{A_Shift<T,R,Boundary>{a.rep(), offset}};
+}
+
+// slice(a, start, size, step) - element i is a[start + i*step]
+template<typename T, typename R>
+Array<T, A_Slice<T,R>> slice(Array<T,R> const& a, std::size_t start, std::size_t size,
+                             std::ptrdiff_t step = 1)
+{
+    return Array<T, A_Slice<T,R>>{A_Slice<T,R>{a.rep(), start, size, step}};
+}
+
+// stencil(a, {w0, ..., wN-1}) - element i is w0*a[i + origin] + ... + wN-1*a[i + origin + N-1],
+// by default centred (origin -(N-1)/2); an N-tap FIR filter y[i] = h0*x[i] + ... + hN-1*x[i-N+1]
+// is stencil(x, {hN-1, ..., h0}, boundary_zero, -(N-1))
+template<typename T, typename R, std::size_t N, typename Boundary = BoundaryZero>
+Array<T, A_Stencil<T,R,Boundary,N>> stencil(Array<T,R> const& a, T const (&weights)[N],
+                                           Boundary = Boundary{},
+                                           std::ptrdiff_t origin = -static_cast<std::ptrdiff_t>(N - 1) / 2)
+{
+    static_assert(N > 0, "stencil: no weights");
+    std::array<T, N> w{};
+    for (std::size_t k = 0; k < N; ++k) {
+        w[k] = weights[k];
+    }
+    return Array<T, A_Stencil<T,R,Boundary,N>>{A_Stencil<T,R,Boundary,N>{a.rep(), w, origin}};
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include "expr_eval.hpp"
+#include "expr_sparse.hpp"
+
+// Chunked evaluation of assignments involving `streamed` representations - arrays which
+// are not kept in memory as a whole, like the memory-mapped files of mapped_array.hpp.
+// A streamed representation declares `static constexpr bool streamed = true;` and provides
+//   will_need(first, last) - elements [first, last) will be accessed next
+//   release(first, last)   - elements [first, last) will not be accessed again
+// The assignment is evaluated a chunk at a time by the usual loops; before a chunk the next
+// one is requested from every streamed leaf and the destination, after it the chunk is
+// released, so only about two chunks per array are resident at any time.
+
+struct StreamPolicy
+{
+    std::size_t chunk_bytes{16u * 1024u * 1024u};  // destination bytes per chunk
+};
+
+
+template<typename E, typename = std::void_t<>>
+struct is_streamed : std::false_type { };
+
+template<typename E>
+struct is_streamed<E, std::void_t<decltype(E::streamed)>> : std::bool_constant<E::streamed> { };
+
+template<typename E>
+constexpr inline bool is_streamed_v = is_streamed<E>::value;
+
+
+// Traversal of the leaves of an expression tree: the operands of a node are whatever its
+// condition(), first(), second() and third() return, anything else is a leaf.
+/* --------------------------------------------------------------------------------------------- */
+template<typename E, typename = std::void_t<>>
+struct has_condition_operand : std::false_type { };
+template<typename E>
+struct has_condition_operand<E, std::void_t<decltype(std::declval<E const&>().condition())>>
+    : std::true_type { };
+
+template<typename E, typename = std::void_t<>>
+struct has_first_operand : std::false_type { };
+template<typename E>
+struct has_first_operand<E, std::void_t<decltype(std::declval<E const&>().first())>>
+    : std::true_type { };
+
+template<typename E, typename = std::void_t<>>
+struct has_second_operand : std::false_type { };
+template<typename E>
+struct has_second_operand<E, std::void_t<decltype(std::declval<E const&>().second())>>
+    : std::true_type { };
+
+template<typename E, typename = std::void_t<>>
+struct has_third_operand : std::false_type { };
+template<typename E>
+struct has_third_operand<E, std::void_t<decltype(std::declval<E const&>().third())>>
+    : std::true_type { };
+
+template<typename E, typename F>
+void for_each_leaf(E const& e, F&& f)
+{
+    constexpr bool node = has_condition_operand<E>::value || has_first_operand<E>::value;
+    if constexpr (!node) {
+        f(e);
+    }
+    if constexpr (has_condition_operand<E>::value) {
+        for_each_leaf(e.condition(), f);
+    }
+    if constexpr (has_first_operand<E>::value) {
+        for_each_leaf(e.first(), f);
+    }
+    if constexpr (has_second_operand<E>::value) {
+        for_each_leaf(e.second(), f);
+    }
+    if constexpr (has_third_operand<E>::value) {
+        for_each_leaf(e.third(), f);
+    }
+}
+
+// does the expression have a streamed leaf
+template<typename E>
+constexpr bool has_streamed_leaf()
+{
+    bool streamed = is_streamed_v<E>;
+    if constexpr (has_condition_operand<E>::value) {
+        streamed = streamed
+                   || has_streamed_leaf<std::decay_t<decltype(std::declval<E const&>().condition())>>();
+    }
+    if constexpr (has_first_operand<E>::value) {
+        streamed = streamed
+                   || has_streamed_leaf<std::decay_t<decltype(std::declval<E const&>().first())>>();
+    }
+    if constexpr (has_second_operand<E>::value) {
+        streamed = streamed
+                   || has_streamed_leaf<std::decay_t<decltype(std::declval<E const&>().second())>>();
+    }
+    if constexpr (has_third_operand<E>::value) {
+        streamed = streamed
+                   || has_streamed_leaf<std::decay_t<decltype(std::declval<E const&>().third())>>();
+    }
+    return streamed;
+}
+/* --------------------------------------------------------------------------------------------- */
+
+
+// dst = src for [0, n), one chunk at a time
+template<typename T, typename Dst, typename Src>
+void eval_streamed(Dst& dst, Src const& src, std::size_t n, StreamPolicy const& policy)
+{
+    // whole packets per chunk, so that only the very last chunk runs a scalar tail
+    std::size_t const chunk = std::max<std::size_t>(64, policy.chunk_bytes / sizeof(T) / 64 * 64);
+
+    auto const advise = [&](std::size_t first, std::size_t last, auto hint) {
+        auto const apply = [&](auto const& leaf) {
+            if constexpr (is_streamed_v<std::decay_t<decltype(leaf)>>) {
+                hint(leaf, first, last);
+            }
+        };
+        apply(dst);
+        for_each_leaf(src, apply);
+    };
+    auto const will_need = [](auto const& leaf, std::size_t first, std::size_t last) {
+        leaf.will_need(first, last);
+    };
+    auto const release = [](auto const& leaf, std::size_t first, std::size_t last) {
+        leaf.release(first, last);
+    };
+
+    advise(0, std::min(n, chunk), will_need);
+    for (std::size_t first = 0; first < n; first += chunk) {
+        std::size_t const last = std::min(n, first + chunk);
+        if (last < n) {
+            advise(last, std::min(n, last + chunk), will_need);
+        }
+        evaluate<T>(dst, src, first, last);
+        advise(first, last, release);
+    }
+}
+
+// dst = src for [0, n): over the support if anything involved is sparse (expr_sparse.hpp),
+// in chunks if any array involved is streamed, in one go otherwise
+template<typename T, typename Dst, typename Src>
+void evaluate_all(Dst& dst, Src const& src, std::size_t n,
+                  StreamPolicy const& policy = StreamPolicy{})
+{
+    if constexpr (is_sparse_rep_v<Dst> || has_sparse_support_v<Src>) {
+        eval_sparse<T>(dst, src, n);
+    }
+    else if constexpr (is_streamed_v<Dst> || has_streamed_leaf<Src>()) {
+        eval_streamed<T>(dst, src, n, policy);
+    }
+    else {
+        evaluate<T>(dst, src, 0, n);
+    }
+}
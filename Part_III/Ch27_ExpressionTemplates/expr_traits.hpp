@@ -1,21 +1,72 @@
 #pragma once
 
+#include <type_traits>
 #include "expr_fwd.hpp"
 
+// Expression trees which only consist of values - scalars and views of arrays (see
+// expr_capture.hpp) combined by nodes - do not refer to any temporary. Nodes hold such
+// operands by value, so that the whole tree is a small trivially copyable object which may
+// outlive the full-expression creating it.
+template<typename T>
+struct is_value_expr : std::false_type { };
+
+template<typename T>
+struct is_value_expr<A_Scalar<T>> : std::true_type { };
+
+template<typename T>
+struct is_value_expr<ArrayView<T>> : std::true_type { };
+
+template<typename T, typename OP1, typename OP2>
+struct is_value_expr<A_Add<T,OP1,OP2>>
+    : std::conjunction<is_value_expr<OP1>, is_value_expr<OP2>> { };
+
+template<typename T, typename OP1, typename OP2>
+struct is_value_expr<A_Mult<T,OP1,OP2>>
+    : std::conjunction<is_value_expr<OP1>, is_value_expr<OP2>> { };
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+struct is_value_expr<A_FMA<T,OP1,OP2,OP3>>
+    : std::conjunction<is_value_expr<OP1>, is_value_expr<OP2>, is_value_expr<OP3>> { };
+
+template<typename T, typename OP1, typename OP2, typename Op>
+struct is_value_expr<A_Binary<T,OP1,OP2,Op>>
+    : std::conjunction<is_value_expr<OP1>, is_value_expr<OP2>> { };
+
+template<typename T, typename OP, typename Op>
+struct is_value_expr<A_Unary<T,OP,Op>> : is_value_expr<OP> { };
+
+template<typename T, typename OP1, typename OP2, typename Cmp>
+struct is_value_expr<A_Compare<T,OP1,OP2,Cmp>>
+    : std::conjunction<is_value_expr<OP1>, is_value_expr<OP2>> { };
+
+template<typename T, typename M, typename OP1, typename OP2>
+struct is_value_expr<A_Where<T,M,OP1,OP2>>
+    : std::conjunction<is_value_expr<M>, is_value_expr<OP1>, is_value_expr<OP2>> { };
+
+template<typename T, typename OP>
+struct is_value_expr<A_Convert<T,OP>> : is_value_expr<OP> { };
+
+template<typename T, typename OP, typename Boundary>
+struct is_value_expr<A_Shift<T,OP,Boundary>> : is_value_expr<OP> { };
+
+template<typename T, typename OP>
+struct is_value_expr<A_Slice<T,OP>> : is_value_expr<OP> { };
+
+template<typename T, typename OP, typename Boundary, std::size_t N>
+struct is_value_expr<A_Stencil<T,OP,Boundary,N>> : is_value_expr<OP> { };
+
+template<typename T>
+constexpr inline bool is_value_expr_v = is_value_expr<T>::value;
+
+
 // Helper traits class to select how to refer t oan expression template node
 // - in general by reference
-// - for scalars by value
+// - for scalars, and trees of values (see above), by value
 
 // primary template
 template<typename T>
 class A_Traits {
 public:
-    using ExprRef = T const&;   // type to refer to is constant reference;
-};
-
-// partial specialization for scalars
-template<typename T>
-class A_Traits<A_Scalar<T>> {
-public:
-    using ExprRef = A_Scalar<T>;    // type to refer to is ordinary value;
+    // type to refer to is constant reference, or ordinary value
+    using ExprRef = std::conditional_t<is_value_expr_v<T>, T, T const&>;
 };
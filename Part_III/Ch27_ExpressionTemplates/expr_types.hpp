@@ -2,7 +2,10 @@
 
 #include <cstddef>
 #include <cassert>
+#include <cmath>
+#include <type_traits>
 #include "expr_fwd.hpp"
+#include "expr_packet.hpp"
 
 // The goal is to encode the expression 1.2*x + x*y in a template expression
 // so that all the operations can be applied in one loop:
@@ -13,23 +16,61 @@
 // expression template node either by value or by reference
 #include "expr_traits.hpp"
 
+// Two operands of the same type may be the very same subexpression, e.g. x*y + x*y.
+// same_expr() compares two expression trees structurally - leaves (arrays) are the same
+// only if they are the same object, scalars if they have the same value.
+// A_Add and A_Mult use it when they are built, and the evaluation loops then evaluate a
+// repeated operand only once per index (see with_shared below).
+// The node overloads follow the node definitions below.
+// Only the two direct operands of an A_Add or A_Mult are compared: a repetition deeper in
+// the tree, as in x*y + (x*y)*z or (x*y + z) * (x*y + w), is still evaluated once per
+// occurrence - the node would need to hand the value of the one to the evaluation of the other.
+template<typename E>
+bool same_expr(E const& a, E const& b)
+{
+    return &a == &b;
+}
+
 // class for objects that represent the addition of two operands
 template<typename T, typename OP1, typename OP2>
 class A_Add {
 private:
     typename A_Traits<OP1>::ExprRef op1;    // first operand
     typename A_Traits<OP2>::ExprRef op2;    // second operand
+    bool shared_;                           // op1 and op2 are the same subexpression
 
 public:
+    using value_type = T;
+    // a packet of the sum can be computed if packets of both operands can
+    static constexpr bool packet_access = is_packet_accessible_v<OP1,T>
+                                          && is_packet_accessible_v<OP2,T>;
+
     // Construct initializes referencs to operands
     A_Add(OP1 const& a, OP2 const& b)
-        : op1{a}, op2{b} { }
+        : op1{a}, op2{b}, shared_{false}
+    {
+        if constexpr (std::is_same_v<OP1,OP2>) {
+            shared_ = same_expr(a, b);
+        }
+    }
 
     // compute sum when value requested
     T operator[] (std::size_t idx) const {
         return op1[idx] + op2[idx];
     }
 
+    // compute Packet<T>::size sums at once
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Packet<T>::add(op1.load_packet(idx), op2.load_packet(idx));
+    }
+
+    // access to the operands
+    OP1 const& first() const { return op1; }
+    OP2 const& second() const { return op2; }
+
+    // x + x - the loops may evaluate x once (see with_shared)
+    bool shared() const { return shared_; }
+
     // size is maximum size
     std::size_t size() const {
         assert (op1.size() == 0 || op2.size() == 0
@@ -44,16 +85,36 @@ class A_Mult {
 private:
     typename A_Traits<OP1>::ExprRef op1;
     typename A_Traits<OP2>::ExprRef op2;
+    bool shared_;
 
 public:
+    using value_type = T;
+    static constexpr bool packet_access = is_packet_accessible_v<OP1,T>
+                                          && is_packet_accessible_v<OP2,T>;
+
     A_Mult(OP1 const& a, OP2 const& b)
-        : op1{a}, op2{b} { }
+        : op1{a}, op2{b}, shared_{false}
+    {
+        if constexpr (std::is_same_v<OP1,OP2>) {
+            shared_ = same_expr(a, b);
+        }
+    }
 
     // compute product when value requested
     T operator[] (std::size_t idx) const {
         return op1[idx] * op2[idx];
     }
 
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Packet<T>::mul(op1.load_packet(idx), op2.load_packet(idx));
+    }
+
+    OP1 const& first() const { return op1; }
+    OP2 const& second() const { return op2; }
+
+    // x * x (see with_shared)
+    bool shared() const { return shared_; }
+
     std::size_t size() const {
         assert (op1.size() == 0 || op2.size() == 0
                 || op1.size() == op2.size());
@@ -61,13 +122,64 @@ public:
     }
 };
 
+// class for objects that represent the fused multiply-add op1*op2 + op3.
+// It is not created explicitly - the operators in expr_ops.hpp rewrite a*b + c into it.
+// When the target supports FMA instructions the product is not rounded separately,
+// so the result may differ from a*b + c in the last bit.
+template<typename T, typename OP1, typename OP2, typename OP3>
+class A_FMA {
+private:
+    typename A_Traits<OP1>::ExprRef op1;
+    typename A_Traits<OP2>::ExprRef op2;
+    typename A_Traits<OP3>::ExprRef op3;
+
+public:
+    using value_type = T;
+    static constexpr bool packet_access = is_packet_accessible_v<OP1,T>
+                                          && is_packet_accessible_v<OP2,T>
+                                          && is_packet_accessible_v<OP3,T>;
+
+    A_FMA(OP1 const& a, OP2 const& b, OP3 const& c)
+        : op1{a}, op2{b}, op3{c} { }
+
+    T operator[] (std::size_t idx) const {
+#if defined(__FMA__) || defined(__AVX512F__)
+        if constexpr (std::is_floating_point_v<T>) {
+            return std::fma(op1[idx], op2[idx], op3[idx]);
+        }
+#endif
+        return op1[idx] * op2[idx] + op3[idx];
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Packet<T>::fmadd(op1.load_packet(idx), op2.load_packet(idx),
+                                op3.load_packet(idx));
+    }
+
+    OP1 const& first() const { return op1; }
+    OP2 const& second() const { return op2; }
+    OP3 const& third() const { return op3; }
+
+    std::size_t size() const {
+        std::size_t const s1 = op1.size(), s2 = op2.size(), s3 = op3.size();
+        std::size_t const s = s1 != 0 ? s1 : (s2 != 0 ? s2 : s3);
+        assert ((s1 == 0 || s1 == s) && (s2 == 0 || s2 == s) && (s3 == 0 || s3 == s));
+        return s;
+    }
+};
+
 // class for objects that represent multiplication with a scalar
+// The scalar is held by value - it is usually a temporary (1.2*x), and holding it
+// by value allows the operators to fold constants (2*(3*x) becomes 6*x).
 template<typename T>
 class A_Scalar {
 private:
-    T const& s; // value of the scalar
+    T s; // value of the scalar
 
 public:
+    using value_type = T;
+    static constexpr bool packet_access = true;
+
     // ctor
     constexpr A_Scalar(T const& v)
         : s{v} { }
@@ -77,38 +189,641 @@ public:
         return s;
     }
 
+    // ...and every element of a packet
+    typename Packet<T>::type load_packet(std::size_t) const {
+        return Packet<T>::broadcast(s);
+    }
+
+    constexpr T const& value() const { return s; }
+
     // scalars have zero as size
     constexpr std::size_t size() const { return 0; }
 };
 
 
+
+// Elementwise operations of the generic nodes below. Each provides the scalar operation
+// apply() and, if `packet` is true, the same operation on a whole packet.
+// There are no packet versions of exp and log - the target has no instructions for them -
+// so expressions using them are evaluated one element at a time (still in a single loop).
+/* --------------------------------------------------------------------------------------------- */
+struct OpSub {
+    static constexpr bool packet = true;
+    template<typename T> static T apply(T a, T b) { return a - b; }
+    template<typename T, typename P> static P apply_packet(P a, P b) {
+        return Packet<T>::sub(a, b);
+    }
+};
+
+struct OpDiv {
+    static constexpr bool packet = true;
+    template<typename T> static T apply(T a, T b) { return a / b; }
+    template<typename T, typename P> static P apply_packet(P a, P b) {
+        return Packet<T>::div(a, b);
+    }
+};
+
+// min and max behave like the SIMD instructions: if either operand is NaN, b is returned
+struct OpMin {
+    static constexpr bool packet = true;
+    template<typename T> static T apply(T a, T b) { return a < b ? a : b; }
+    template<typename T, typename P> static P apply_packet(P a, P b) {
+        return Packet<T>::min(a, b);
+    }
+};
+
+struct OpMax {
+    static constexpr bool packet = true;
+    template<typename T> static T apply(T a, T b) { return a > b ? a : b; }
+    template<typename T, typename P> static P apply_packet(P a, P b) {
+        return Packet<T>::max(a, b);
+    }
+};
+
+struct OpNeg {
+    static constexpr bool packet = true;
+    template<typename T> static T apply(T a) { return -a; }
+    template<typename T, typename P> static P apply_packet(P a) { return Packet<T>::neg(a); }
+};
+
+struct OpAbs {
+    static constexpr bool packet = true;
+    template<typename T> static T apply(T a) { return std::abs(a); }
+    template<typename T, typename P> static P apply_packet(P a) { return Packet<T>::abs(a); }
+};
+
+struct OpSqrt {
+    static constexpr bool packet = true;
+    template<typename T> static T apply(T a) { return std::sqrt(a); }
+    template<typename T, typename P> static P apply_packet(P a) { return Packet<T>::sqrt(a); }
+};
+
+// e + e and e * e with e evaluated once (see with_shared)
+struct OpTwice {
+    static constexpr bool packet = true;
+    template<typename T> static T apply(T a) { return a + a; }
+    template<typename T, typename P> static P apply_packet(P a) { return Packet<T>::add(a, a); }
+};
+
+struct OpSquare {
+    static constexpr bool packet = true;
+    template<typename T> static T apply(T a) { return a * a; }
+    template<typename T, typename P> static P apply_packet(P a) { return Packet<T>::mul(a, a); }
+};
+
+struct OpExp {
+    static constexpr bool packet = false;
+    template<typename T> static T apply(T a) { return std::exp(a); }
+};
+
+struct OpLog {
+    static constexpr bool packet = false;
+    template<typename T> static T apply(T a) { return std::log(a); }
+};
+
+// comparisons - apply() yields a bool, apply_packet() a Packet<T>::mask_type
+struct CmpLess {
+    template<typename T> static bool apply(T a, T b) { return a < b; }
+    template<typename T, typename P> static auto apply_packet(P a, P b) {
+        return Packet<T>::lt(a, b);
+    }
+};
+
+struct CmpLessEqual {
+    template<typename T> static bool apply(T a, T b) { return a <= b; }
+    template<typename T, typename P> static auto apply_packet(P a, P b) {
+        return Packet<T>::le(a, b);
+    }
+};
+
+struct CmpGreater {
+    template<typename T> static bool apply(T a, T b) { return a > b; }
+    template<typename T, typename P> static auto apply_packet(P a, P b) {
+        return Packet<T>::gt(a, b);
+    }
+};
+
+struct CmpGreaterEqual {
+    template<typename T> static bool apply(T a, T b) { return a >= b; }
+    template<typename T, typename P> static auto apply_packet(P a, P b) {
+        return Packet<T>::ge(a, b);
+    }
+};
+
+struct CmpEqual {
+    template<typename T> static bool apply(T a, T b) { return a == b; }
+    template<typename T, typename P> static auto apply_packet(P a, P b) {
+        return Packet<T>::eq(a, b);
+    }
+};
+
+struct CmpNotEqual {
+    template<typename T> static bool apply(T a, T b) { return a != b; }
+    template<typename T, typename P> static auto apply_packet(P a, P b) {
+        return Packet<T>::ne(a, b);
+    }
+};
+/* --------------------------------------------------------------------------------------------- */
+
+
+// class for objects that represent an elementwise binary operation Op (a - b, a / b, min, max)
+template<typename T, typename OP1, typename OP2, typename Op>
+class A_Binary {
+private:
+    typename A_Traits<OP1>::ExprRef op1;
+    typename A_Traits<OP2>::ExprRef op2;
+
+public:
+    using value_type = T;
+    static constexpr bool packet_access = Op::packet
+                                          && is_packet_accessible_v<OP1,T>
+                                          && is_packet_accessible_v<OP2,T>;
+
+    A_Binary(OP1 const& a, OP2 const& b)
+        : op1{a}, op2{b} { }
+
+    T operator[] (std::size_t idx) const {
+        return Op::template apply<T>(op1[idx], op2[idx]);
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Op::template apply_packet<T>(op1.load_packet(idx), op2.load_packet(idx));
+    }
+
+    OP1 const& first() const { return op1; }
+    OP2 const& second() const { return op2; }
+
+    std::size_t size() const {
+        assert (op1.size() == 0 || op2.size() == 0
+                || op1.size() == op2.size());
+        return op1.size() != 0 ? op1.size() : op2.size();
+    }
+};
+
+// class for objects that represent an elementwise unary operation Op (-a, abs, sqrt, exp, log)
+template<typename T, typename OP, typename Op>
+class A_Unary {
+private:
+    typename A_Traits<OP>::ExprRef op;
+
+public:
+    using value_type = T;
+    static constexpr bool packet_access = Op::packet && is_packet_accessible_v<OP,T>;
+
+    explicit A_Unary(OP const& a)
+        : op{a} { }
+
+    T operator[] (std::size_t idx) const {
+        return Op::template apply<T>(op[idx]);
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Op::template apply_packet<T>(op.load_packet(idx));
+    }
+
+    OP const& first() const { return op; }
+
+    std::size_t size() const { return op.size(); }
+};
+
+// class for objects that represent the elementwise comparison of two operands of type T.
+// The elements are bools, so a comparison can be assigned to an Array<bool> (a mask array).
+// It cannot be loaded as a packet of bools, but inside where() it provides the packet
+// mask directly through load_mask(), so that where(x < y, ...) stays a packet loop.
+template<typename T, typename OP1, typename OP2, typename Cmp>
+class A_Compare {
+private:
+    typename A_Traits<OP1>::ExprRef op1;
+    typename A_Traits<OP2>::ExprRef op2;
+
+public:
+    using value_type = bool;
+    using operand_type = T;
+    static constexpr bool packet_access = false;
+    static constexpr bool mask_access = is_packet_accessible_v<OP1,T>
+                                        && is_packet_accessible_v<OP2,T>;
+
+    A_Compare(OP1 const& a, OP2 const& b)
+        : op1{a}, op2{b} { }
+
+    bool operator[] (std::size_t idx) const {
+        return Cmp::template apply<T>(op1[idx], op2[idx]);
+    }
+
+    typename Packet<T>::mask_type load_mask(std::size_t idx) const {
+        return Cmp::template apply_packet<T>(op1.load_packet(idx), op2.load_packet(idx));
+    }
+
+    OP1 const& first() const { return op1; }
+    OP2 const& second() const { return op2; }
+
+    std::size_t size() const {
+        assert (op1.size() == 0 || op2.size() == 0
+                || op1.size() == op2.size());
+        return op1.size() != 0 ? op1.size() : op2.size();
+    }
+};
+
+// Detect a mask expression that can provide Packet<T>::mask_type values, i.e. declares
+// `static constexpr bool mask_access = true;` and provides load_mask(idx).
+template<typename M, typename T, typename = std::void_t<>>
+struct is_mask_accessible : std::false_type { };
+
+template<typename M, typename T>
+struct is_mask_accessible<M, T, std::void_t<decltype(M::mask_access),
+                                            typename M::operand_type>>
+    : std::bool_constant<M::mask_access && std::is_same_v<typename M::operand_type, T>> { };
+
+template<typename M, typename T>
+constexpr inline bool is_mask_accessible_v = is_mask_accessible<M,T>::value;
+
+// class for objects that represent where(mask, a, b) - a where the mask is set, b elsewhere.
+// Element by element only the selected operand is evaluated; a packet at a time both are,
+// and the lanes are blended.
+template<typename T, typename M, typename OP1, typename OP2>
+class A_Where {
+private:
+    typename A_Traits<M>::ExprRef mask;
+    typename A_Traits<OP1>::ExprRef op1;
+    typename A_Traits<OP2>::ExprRef op2;
+
+public:
+    using value_type = T;
+    static constexpr bool packet_access = is_mask_accessible_v<M,T>
+                                          && is_packet_accessible_v<OP1,T>
+                                          && is_packet_accessible_v<OP2,T>;
+
+    A_Where(M const& m, OP1 const& a, OP2 const& b)
+        : mask{m}, op1{a}, op2{b} { }
+
+    T operator[] (std::size_t idx) const {
+        if (mask[idx]) {
+            return op1[idx];
+        }
+        return op2[idx];
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Packet<T>::select(mask.load_mask(idx), op1.load_packet(idx),
+                                 op2.load_packet(idx));
+    }
+
+    M const& condition() const { return mask; }
+    OP1 const& first() const { return op1; }
+    OP2 const& second() const { return op2; }
+
+    std::size_t size() const {
+        std::size_t const s1 = op1.size(), s2 = op2.size();
+        std::size_t const s = mask.size() != 0 ? mask.size() : (s1 != 0 ? s1 : s2);
+        assert ((s1 == 0 || s1 == s) && (s2 == 0 || s2 == s));
+        return s;
+    }
+};
+
+// Mixed precision
+// An operation on operands of different types T1 and T2 (a float array and a double scalar,
+// a float and a double array, ...) has the type of the built-in operation, promoted_t.
+// Operands of another type are presented in that type by A_Convert, so the nodes themselves
+// still compute in a single type. Storing the result into an array of a narrower type
+// converts it at that point (see eval_convert() in expr_eval.hpp).
+/* --------------------------------------------------------------------------------------------- */
+template<typename T1, typename T2>
+using promoted_t = decltype(std::declval<T1>() + std::declval<T2>());
+
+// class for objects that present the elements of OP, of another value type, as T.
+// Contiguous arrays are converted a packet at a time while they are loaded, if the target
+// has the conversion instructions, so that e.g. a float array within a double expression
+// is read as floats - half the bytes of a double copy of it. Any other operand is converted
+// element by element.
+template<typename T, typename OP>
+class A_Convert {
+private:
+    typename A_Traits<OP>::ExprRef op;
+
+public:
+    using value_type = T;
+    using operand_type = typename OP::value_type;
+    static constexpr bool packet_access = has_packet_convert_v<T, operand_type>
+                                          && has_contiguous_data_v<OP>;
+
+    explicit A_Convert(OP const& a)
+        : op{a} { }
+
+    T operator[] (std::size_t idx) const {
+        return static_cast<T>(op[idx]);
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return PacketConvert<T, operand_type>::load(op.data() + idx);
+    }
+
+    OP const& first() const { return op; }
+
+    std::size_t size() const { return op.size(); }
+};
+
+// conversions are created as temporaries inside the operators, so nodes refer to them
+// by value (they are small)
+template<typename T, typename OP>
+class A_Traits<A_Convert<T,OP>> {
+public:
+    using ExprRef = A_Convert<T,OP>;
+};
+/* --------------------------------------------------------------------------------------------- */
+
+// can x[y] be loaded a packet at a time: x and y must be contiguous in memory
+// and the target must have a gather instruction for the value and index type
+template<typename T, typename A1, typename A2, typename = void>
+struct is_gatherable : std::false_type { };
+
+template<typename T, typename A1, typename A2>
+struct is_gatherable<T, A1, A2, std::void_t<typename A1::value_type, typename A2::value_type>>
+    : std::bool_constant<has_contiguous_data_v<A1> && has_contiguous_data_v<A2>
+                         && std::is_same_v<typename A1::value_type, T>
+                         && has_packet_gather_v<T, typename A2::value_type>> { };
+
 // A type that enables expressions like:
 //   x[y] = 2*x[y];
 // Which means that the produced result is writable
+// The subscripted array is therefore referred to by non-const reference.
 template<typename T, typename A1, typename A2>
 class A_Subscript
 {
 public:
+    using value_type = T;
+    // see expr_gather.hpp for the evaluation loops
+    static constexpr bool packet_access = is_gatherable<T,A1,A2>::value;
+
     // ctor
-    A_Subscript(A1 const& a, A2 const& b)
+    A_Subscript(A1& a, A2 const& b)
         : a1{a}, a2{b} { }
 
     // process subscription when value requested
     // decltype(auto) correctly hadnles prvalues / lvalues
     decltype(auto) operator[](std::size_t idx) const
     {
-        return a1[a2[idx]];
+        return a1[static_cast<std::size_t>(a2[idx])];
     }
 
     T& operator[](std::size_t idx)
     {
-        return a1[a2[idx]];
+        return a1[static_cast<std::size_t>(a2[idx])];
+    }
+
+    auto load_packet(std::size_t idx) const {
+        return PacketGather<T, typename A2::value_type>::gather(a1.data(), a2.data() + idx);
     }
 
     // size is size of inner array
     std::size_t size() const { return a2.size(); }
 
+    // access to the operands
+    A1& array() { return a1; }
+    A1 const& array() const { return a1; }
+    A2 const& indices() const { return a2; }
+
 private:
-    A1 const& a1;       // reference to first operand
+    A1& a1;             // reference to first operand
     A2 const& a2;       // reference to second operand
 };
+
+
+// structural comparison of expression nodes, see same_expr() above
+template<typename T>
+bool same_expr(A_Scalar<T> const& a, A_Scalar<T> const& b)
+{
+    return a.value() == b.value();
+}
+
+template<typename T, typename OP1, typename OP2>
+bool same_expr(A_Add<T,OP1,OP2> const& a, A_Add<T,OP1,OP2> const& b)
+{
+    return same_expr(a.first(), b.first()) && same_expr(a.second(), b.second());
+}
+
+template<typename T, typename OP1, typename OP2>
+bool same_expr(A_Mult<T,OP1,OP2> const& a, A_Mult<T,OP1,OP2> const& b)
+{
+    return same_expr(a.first(), b.first()) && same_expr(a.second(), b.second());
+}
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+bool same_expr(A_FMA<T,OP1,OP2,OP3> const& a, A_FMA<T,OP1,OP2,OP3> const& b)
+{
+    return same_expr(a.first(), b.first()) && same_expr(a.second(), b.second())
+           && same_expr(a.third(), b.third());
+}
+
+template<typename T, typename OP1, typename OP2, typename Op>
+bool same_expr(A_Binary<T,OP1,OP2,Op> const& a, A_Binary<T,OP1,OP2,Op> const& b)
+{
+    return same_expr(a.first(), b.first()) && same_expr(a.second(), b.second());
+}
+
+template<typename T, typename OP, typename Op>
+bool same_expr(A_Unary<T,OP,Op> const& a, A_Unary<T,OP,Op> const& b)
+{
+    return same_expr(a.first(), b.first());
+}
+
+template<typename T, typename OP1, typename OP2, typename Cmp>
+bool same_expr(A_Compare<T,OP1,OP2,Cmp> const& a, A_Compare<T,OP1,OP2,Cmp> const& b)
+{
+    return same_expr(a.first(), b.first()) && same_expr(a.second(), b.second());
+}
+
+template<typename T, typename M, typename OP1, typename OP2>
+bool same_expr(A_Where<T,M,OP1,OP2> const& a, A_Where<T,M,OP1,OP2> const& b)
+{
+    return same_expr(a.condition(), b.condition()) && same_expr(a.first(), b.first())
+           && same_expr(a.second(), b.second());
+}
+
+template<typename T, typename OP>
+bool same_expr(A_Convert<T,OP> const& a, A_Convert<T,OP> const& b)
+{
+    return same_expr(a.first(), b.first());
+}
+
+
+// with_shared(e, f) - f(e), with every A_Add or A_Mult found shared when it was built (x + x,
+// x * x) replaced by the A_Unary that evaluates its operand once (OpTwice, OpSquare).
+// The evaluation loops are written as f, so that they are instantiated once per combination
+// of shared and unshared nodes, and the choice between them is made once, before the loop,
+// instead of at every packet. Sharing is looked for under the arithmetic nodes (A_Add, A_Mult,
+// A_FMA, A_Binary, A_Unary); a tree without an A_Add or A_Mult of two operands of the same
+// type there is passed on as it is.
+/* --------------------------------------------------------------------------------------------- */
+template<typename E>
+struct may_share : std::false_type { };
+
+template<typename T, typename OP1, typename OP2>
+struct may_share<A_Add<T,OP1,OP2>>
+    : std::disjunction<std::is_same<OP1,OP2>, may_share<OP1>, may_share<OP2>> { };
+
+template<typename T, typename OP1, typename OP2>
+struct may_share<A_Mult<T,OP1,OP2>>
+    : std::disjunction<std::is_same<OP1,OP2>, may_share<OP1>, may_share<OP2>> { };
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+struct may_share<A_FMA<T,OP1,OP2,OP3>>
+    : std::disjunction<may_share<OP1>, may_share<OP2>, may_share<OP3>> { };
+
+template<typename T, typename OP1, typename OP2, typename Op>
+struct may_share<A_Binary<T,OP1,OP2,Op>> : std::disjunction<may_share<OP1>, may_share<OP2>> { };
+
+template<typename T, typename OP, typename Op>
+struct may_share<A_Unary<T,OP,Op>> : may_share<OP> { };
+
+template<typename E>
+constexpr inline bool may_share_v = may_share<E>::value;
+
+template<typename E, typename F>
+void with_shared(E const& e, F&& f)
+{
+    f(e);
+}
+
+template<typename T, typename OP1, typename OP2, typename F>
+void with_shared(A_Add<T,OP1,OP2> const& e, F&& f)
+{
+    if constexpr (!may_share_v<A_Add<T,OP1,OP2>>) {
+        f(e);
+    }
+    else {
+        if constexpr (std::is_same_v<OP1,OP2>) {
+            if (e.shared()) {
+                with_shared(e.first(), [&](auto const& a) {
+                    f(A_Unary<T, std::decay_t<decltype(a)>, OpTwice>{a});
+                });
+                return;
+            }
+        }
+        with_shared(e.first(), [&](auto const& a) {
+            with_shared(e.second(), [&](auto const& b) {
+                f(A_Add<T, std::decay_t<decltype(a)>, std::decay_t<decltype(b)>>{a, b});
+            });
+        });
+    }
+}
+
+template<typename T, typename OP1, typename OP2, typename F>
+void with_shared(A_Mult<T,OP1,OP2> const& e, F&& f)
+{
+    if constexpr (!may_share_v<A_Mult<T,OP1,OP2>>) {
+        f(e);
+    }
+    else {
+        if constexpr (std::is_same_v<OP1,OP2>) {
+            if (e.shared()) {
+                with_shared(e.first(), [&](auto const& a) {
+                    f(A_Unary<T, std::decay_t<decltype(a)>, OpSquare>{a});
+                });
+                return;
+            }
+        }
+        with_shared(e.first(), [&](auto const& a) {
+            with_shared(e.second(), [&](auto const& b) {
+                f(A_Mult<T, std::decay_t<decltype(a)>, std::decay_t<decltype(b)>>{a, b});
+            });
+        });
+    }
+}
+
+template<typename T, typename OP1, typename OP2, typename OP3, typename F>
+void with_shared(A_FMA<T,OP1,OP2,OP3> const& e, F&& f)
+{
+    if constexpr (!may_share_v<A_FMA<T,OP1,OP2,OP3>>) {
+        f(e);
+    }
+    else {
+        with_shared(e.first(), [&](auto const& a) {
+            with_shared(e.second(), [&](auto const& b) {
+                with_shared(e.third(), [&](auto const& c) {
+                    f(A_FMA<T, std::decay_t<decltype(a)>, std::decay_t<decltype(b)>,
+                            std::decay_t<decltype(c)>>{a, b, c});
+                });
+            });
+        });
+    }
+}
+
+template<typename T, typename OP1, typename OP2, typename Op, typename F>
+void with_shared(A_Binary<T,OP1,OP2,Op> const& e, F&& f)
+{
+    if constexpr (!may_share_v<A_Binary<T,OP1,OP2,Op>>) {
+        f(e);
+    }
+    else {
+        with_shared(e.first(), [&](auto const& a) {
+            with_shared(e.second(), [&](auto const& b) {
+                f(A_Binary<T, std::decay_t<decltype(a)>, std::decay_t<decltype(b)>, Op>{a, b});
+            });
+        });
+    }
+}
+
+template<typename T, typename OP, typename Op, typename F>
+void with_shared(A_Unary<T,OP,Op> const& e, F&& f)
+{
+    if constexpr (!may_share_v<A_Unary<T,OP,Op>>) {
+        f(e);
+    }
+    else {
+        with_shared(e.first(), [&](auto const& a) {
+            f(A_Unary<T, std::decay_t<decltype(a)>, Op>{a});
+        });
+    }
+}
+/* --------------------------------------------------------------------------------------------- */
+
+// Number of elements of an expression known at compile time, 0 if it is only known at run time.
+// Array representations with a compile-time size declare `static constexpr std::size_t
+// static_size` (see FixedArray), nodes take it from their operands.
+/* --------------------------------------------------------------------------------------------- */
+template<typename E, typename = std::void_t<>>
+struct static_size : std::integral_constant<std::size_t, 0> { };
+
+template<typename E>
+struct static_size<E, std::void_t<decltype(E::static_size)>>
+    : std::integral_constant<std::size_t, E::static_size> { };
+
+template<typename... Ops>
+struct common_static_size : std::integral_constant<std::size_t, 0> { };
+
+template<typename Op, typename... Ops>
+struct common_static_size<Op, Ops...>
+    : std::integral_constant<std::size_t, static_size<Op>::value != 0
+                                          ? static_size<Op>::value
+                                          : common_static_size<Ops...>::value> { };
+
+template<typename T, typename OP1, typename OP2>
+struct static_size<A_Add<T,OP1,OP2>> : common_static_size<OP1,OP2> { };
+
+template<typename T, typename OP1, typename OP2>
+struct static_size<A_Mult<T,OP1,OP2>> : common_static_size<OP1,OP2> { };
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+struct static_size<A_FMA<T,OP1,OP2,OP3>> : common_static_size<OP1,OP2,OP3> { };
+
+template<typename T, typename OP1, typename OP2, typename Op>
+struct static_size<A_Binary<T,OP1,OP2,Op>> : common_static_size<OP1,OP2> { };
+
+template<typename T, typename OP, typename Op>
+struct static_size<A_Unary<T,OP,Op>> : static_size<OP> { };
+
+template<typename T, typename OP1, typename OP2, typename Cmp>
+struct static_size<A_Compare<T,OP1,OP2,Cmp>> : common_static_size<OP1,OP2> { };
+
+template<typename T, typename M, typename OP1, typename OP2>
+struct static_size<A_Where<T,M,OP1,OP2>> : common_static_size<M,OP1,OP2> { };
+
+template<typename T, typename OP>
+struct static_size<A_Convert<T,OP>> : static_size<OP> { };
+
+template<typename T, typename A1, typename A2>
+struct static_size<A_Subscript<T,A1,A2>> : static_size<A2> { };
+
+template<typename E>
+constexpr inline std::size_t static_size_v = static_size<E>::value;
+/* --------------------------------------------------------------------------------------------- */
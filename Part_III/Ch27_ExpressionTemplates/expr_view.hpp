@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include "expr_types.hpp"
+#include "expr_packet.hpp"
+
+// Views of arrays, and the copy of an expression tree over views of its arrays
+// (capture_rep), which holds all of its operands by value (see expr_traits.hpp).
+// Such copies are what expr_capture.hpp stores. The evaluation loops make one too: in a
+// local copy the compiler knows the pointers and scalars of the tree to be unchanged by the
+// stores of the loop, and keeps them in registers (see local_rep).
+
+
+// class for objects that refer to n contiguous elements of type T, or of `T const` for a
+// view that can only be read. Like a pointer the view itself can be copied freely,
+// and constness of the view does not make the elements constant.
+template<typename T>
+class ArrayView
+{
+public:
+    using value_type = std::remove_const_t<T>;
+    static constexpr bool packet_access = true;
+
+    constexpr ArrayView(T* data, std::size_t n)
+        : data_{data}, size_{n} { }
+
+    constexpr std::size_t size() const { return size_; }
+
+    constexpr T& operator[](std::size_t idx) const {
+        return data_[idx];
+    }
+
+    typename Packet<value_type>::type load_packet(std::size_t idx) const {
+        return Packet<value_type>::load(data_ + idx);
+    }
+
+    // (only for views of writable elements)
+    template<typename U = T, typename = std::enable_if_t<!std::is_const_v<U>>>
+    void store_packet(std::size_t idx, typename Packet<value_type>::type v) const {
+        Packet<value_type>::store(data_ + idx, v);
+    }
+
+    constexpr T* data() const { return data_; }
+
+private:
+    T* data_;
+    std::size_t size_;
+};
+
+// views are the same leaf if they view the same elements
+template<typename T>
+bool same_expr(ArrayView<T> const& a, ArrayView<T> const& b)
+{
+    return a.data() == b.data() && a.size() == b.size();
+}
+
+
+// capture_rep(e) - the tree of e with every leaf replaced by a view of it
+/* --------------------------------------------------------------------------------------------- */
+template<typename E>
+auto capture_rep(E const& leaf)
+{
+    static_assert(has_contiguous_data_v<E>,
+                  "capture: leaves must store their elements contiguously (provide data())");
+    using T = typename E::value_type;
+    return ArrayView<T const>{leaf.data(), leaf.size()};
+}
+
+template<typename T>
+A_Scalar<T> capture_rep(A_Scalar<T> const& s)
+{
+    return s;
+}
+
+template<typename T>
+ArrayView<T> capture_rep(ArrayView<T> const& v)
+{
+    return v;
+}
+
+template<typename T, typename OP1, typename OP2>
+auto capture_rep(A_Add<T,OP1,OP2> const& e)
+{
+    auto a = capture_rep(e.first());
+    auto b = capture_rep(e.second());
+    return A_Add<T, decltype(a), decltype(b)>{a, b};
+}
+
+template<typename T, typename OP1, typename OP2>
+auto capture_rep(A_Mult<T,OP1,OP2> const& e)
+{
+    auto a = capture_rep(e.first());
+    auto b = capture_rep(e.second());
+    return A_Mult<T, decltype(a), decltype(b)>{a, b};
+}
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+auto capture_rep(A_FMA<T,OP1,OP2,OP3> const& e)
+{
+    auto a = capture_rep(e.first());
+    auto b = capture_rep(e.second());
+    auto c = capture_rep(e.third());
+    return A_FMA<T, decltype(a), decltype(b), decltype(c)>{a, b, c};
+}
+
+template<typename T, typename OP1, typename OP2, typename Op>
+auto capture_rep(A_Binary<T,OP1,OP2,Op> const& e)
+{
+    auto a = capture_rep(e.first());
+    auto b = capture_rep(e.second());
+    return A_Binary<T, decltype(a), decltype(b), Op>{a, b};
+}
+
+template<typename T, typename OP, typename Op>
+auto capture_rep(A_Unary<T,OP,Op> const& e)
+{
+    auto a = capture_rep(e.first());
+    return A_Unary<T, decltype(a), Op>{a};
+}
+
+template<typename T, typename OP1, typename OP2, typename Cmp>
+auto capture_rep(A_Compare<T,OP1,OP2,Cmp> const& e)
+{
+    auto a = capture_rep(e.first());
+    auto b = capture_rep(e.second());
+    return A_Compare<T, decltype(a), decltype(b), Cmp>{a, b};
+}
+
+template<typename T, typename M, typename OP1, typename OP2>
+auto capture_rep(A_Where<T,M,OP1,OP2> const& e)
+{
+    auto m = capture_rep(e.condition());
+    auto a = capture_rep(e.first());
+    auto b = capture_rep(e.second());
+    return A_Where<T, decltype(m), decltype(a), decltype(b)>{m, a, b};
+}
+
+template<typename T, typename OP>
+auto capture_rep(A_Convert<T,OP> const& e)
+{
+    auto a = capture_rep(e.first());
+    return A_Convert<T, decltype(a)>{a};
+}
+
+template<typename T, typename OP, typename Boundary>
+auto capture_rep(A_Shift<T,OP,Boundary> const& e)
+{
+    auto a = capture_rep(e.first());
+    return A_Shift<T, decltype(a), Boundary>{a, e.offset()};
+}
+
+template<typename T, typename OP>
+auto capture_rep(A_Slice<T,OP> const& e)
+{
+    auto a = capture_rep(e.first());
+    return A_Slice<T, decltype(a)>{a, e.start(), e.size(), e.step()};
+}
+
+template<typename T, typename OP, typename Boundary, std::size_t N>
+auto capture_rep(A_Stencil<T,OP,Boundary,N> const& e)
+{
+    auto a = capture_rep(e.first());
+    return A_Stencil<T, decltype(a), Boundary, N>{a, e.weights(), e.origin()};
+}
+
+// x[y] writes through its array, so it is not captured
+template<typename T, typename A1, typename A2>
+void capture_rep(A_Subscript<T,A1,A2> const&) = delete;
+/* --------------------------------------------------------------------------------------------- */
+
+// Can the tree be copied over views of its arrays: every leaf a scalar or an array of
+// contiguous elements, every node one that capture_rep rebuilds
+/* --------------------------------------------------------------------------------------------- */
+template<typename E, typename = std::void_t<>>
+struct is_capturable : std::false_type { };
+
+template<typename E>
+struct is_capturable<E, std::void_t<decltype(std::declval<E const&>().data())>>
+    : std::is_same<std::remove_cv_t<std::remove_pointer_t<decltype(std::declval<E const&>().data())>>,
+                   typename E::value_type> { };
+
+template<typename T>
+struct is_capturable<A_Scalar<T>> : std::true_type { };
+
+template<typename T, typename OP1, typename OP2>
+struct is_capturable<A_Add<T,OP1,OP2>>
+    : std::conjunction<is_capturable<OP1>, is_capturable<OP2>> { };
+
+template<typename T, typename OP1, typename OP2>
+struct is_capturable<A_Mult<T,OP1,OP2>>
+    : std::conjunction<is_capturable<OP1>, is_capturable<OP2>> { };
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+struct is_capturable<A_FMA<T,OP1,OP2,OP3>>
+    : std::conjunction<is_capturable<OP1>, is_capturable<OP2>, is_capturable<OP3>> { };
+
+template<typename T, typename OP1, typename OP2, typename Op>
+struct is_capturable<A_Binary<T,OP1,OP2,Op>>
+    : std::conjunction<is_capturable<OP1>, is_capturable<OP2>> { };
+
+template<typename T, typename OP, typename Op>
+struct is_capturable<A_Unary<T,OP,Op>> : is_capturable<OP> { };
+
+template<typename T, typename OP1, typename OP2, typename Cmp>
+struct is_capturable<A_Compare<T,OP1,OP2,Cmp>>
+    : std::conjunction<is_capturable<OP1>, is_capturable<OP2>> { };
+
+template<typename T, typename M, typename OP1, typename OP2>
+struct is_capturable<A_Where<T,M,OP1,OP2>>
+    : std::conjunction<is_capturable<M>, is_capturable<OP1>, is_capturable<OP2>> { };
+
+template<typename T, typename OP>
+struct is_capturable<A_Convert<T,OP>> : is_capturable<OP> { };
+
+template<typename T, typename OP, typename Boundary>
+struct is_capturable<A_Shift<T,OP,Boundary>> : is_capturable<OP> { };
+
+template<typename T, typename OP>
+struct is_capturable<A_Slice<T,OP>> : is_capturable<OP> { };
+
+template<typename T, typename OP, typename Boundary, std::size_t N>
+struct is_capturable<A_Stencil<T,OP,Boundary,N>> : is_capturable<OP> { };
+
+template<typename E>
+constexpr inline bool is_capturable_v = is_capturable<E>::value;
+/* --------------------------------------------------------------------------------------------- */
+
+
+// The tree an evaluation loop runs over: a local copy of src over views of its arrays if
+// it can be made, src itself otherwise.
+//   auto const& e = local_rep(src);
+// (Packet stores are of may_alias vector types, so after each of them the compiler would
+// reload whatever the nodes of src hold - array pointers, scalars, weights.)
+template<typename Src>
+decltype(auto) local_rep(Src const& src)
+{
+    if constexpr (is_capturable_v<Src>) {
+        return capture_rep(src);
+    }
+    else {
+        return (src);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include "simple_array.hpp"
+#include "expr_packet.hpp"
+
+
+// Array representation with N elements stored inline, e.g. for 3d vectors or quaternions:
+//   Array<double, FixedArray<double,3>> v{3};
+// Creating one never allocates, and since the size is known at compile time
+// (static_size), assignments and reductions are fully unrolled for small N
+// (see eval_unrolled() in expr_eval.hpp).
+template<typename T, std::size_t N>
+class FixedArray
+{
+public:
+    using value_type = T;
+    static constexpr bool packet_access = true;
+    static constexpr std::size_t static_size = N;
+
+    // create array, the size is only checked (it can only be N)
+    explicit FixedArray(std::size_t s = N)
+        : storage_{}
+        {
+            assert(s == N);
+            (void)s;
+        }
+
+    // create array without initializing the elements
+    FixedArray(std::size_t s, uninitialized_t)
+        {
+            assert(s == N);
+            (void)s;
+        }
+
+    static constexpr std::size_t size() {
+        return N;
+    }
+
+    T const& operator[](std::size_t idx) const {
+        return storage_[idx];
+    }
+
+    T& operator[](std::size_t idx) {
+        return storage_[idx];
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Packet<T>::load(storage_ + idx);
+    }
+
+    void store_packet(std::size_t idx, typename Packet<T>::type v) {
+        Packet<T>::store(storage_ + idx, v);
+    }
+
+    T const* data() const { return storage_; }
+    T* data() { return storage_; }
+
+private:
+    T storage_[N];
+};
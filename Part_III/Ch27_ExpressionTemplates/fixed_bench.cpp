@@ -0,0 +1,57 @@
+#include <iostream>
+#include <cstdlib>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "expr_reduce.hpp"
+#include "fixed_array.hpp"
+#include "small_array.hpp"
+#include "bench_util.hpp"
+
+
+// Many tiny arrays: every iteration creates a 3-element vector v = a*x + p and accumulates
+// its squared length, with three representations of the vectors:
+// - SArray     - every vector is allocated on the heap
+// - SmallArray - the elements of short vectors are stored inside the object
+// - FixedArray - inline storage and a compile-time size, all loops fully unrolled
+template<typename Rep>
+double run(std::size_t iterations)
+{
+    Array<double, Rep> x{3}, p{3};
+    x[0] = 1.0; x[1] = 2.0; x[2] = 3.0;
+    p[0] = 0.5; p[1] = 0.25; p[2] = 0.125;
+
+    double acc = 0.0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        double const a = 1.0 / static_cast<double>(i + 1);
+        Array<double, Rep> v{3, uninitialized};
+        v = a*x + p;
+        acc += dot(v, v);
+    }
+    return acc;
+}
+
+using Fixed3 = FixedArray<double,3>;
+static_assert(sizeof(Array<double, Fixed3>) == 3 * sizeof(double));
+static_assert(static_size_v<A_FMA<double, A_Scalar<double>, Fixed3, Fixed3>> == 3);
+
+int main(int argc, char* argv[])
+{
+    std::size_t const iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000;
+
+    auto const report = [iterations](char const* name, auto rep){
+        using Rep = decltype(rep);
+        double result = 0.0;
+        std::size_t const allocs_before = AllocationCounter::count;
+        auto const ns = time_ns([&]{
+            result = run<Rep>(iterations);
+            do_not_optimize(result);
+        }, 3);
+        std::size_t const allocs = AllocationCounter::count - allocs_before;
+        std::cout << name << ns / static_cast<double>(iterations) << " ns/iteration, "
+                  << static_cast<double>(allocs) / (3.0 * static_cast<double>(iterations))
+                  << " allocations/iteration (result " << result << ")\n";
+    };
+    report("SArray:     ", SArray<double, CountingAllocator<double>>{0});
+    report("SmallArray: ", SmallArray<double, 8, CountingAllocator<double>>{0});
+    report("FixedArray: ", Fixed3{});
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "expr_packet.hpp"
+
+// 16-bit floating point formats for storage only - they halve the memory traffic of large
+// float arrays, while all arithmetic is done in float (see Float16Array):
+// - bfloat16: the upper half of a float - the same range, 8 significant bits
+// - half:     IEEE 754 binary16 - 11 significant bits, but a range of only +-65504
+// Conversions from float round to nearest even; NaNs stay (quiet) NaNs.
+
+
+inline std::uint32_t float_bits(float f)
+{
+    std::uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(std::uint32_t u)
+{
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+
+struct bfloat16
+{
+    std::uint16_t bits;
+
+    bfloat16() = default;
+
+    explicit bfloat16(float f)
+        : bits{from_float(f)} { }
+
+    explicit operator float() const {
+        return bits_float(std::uint32_t{bits} << 16);
+    }
+
+    static std::uint16_t from_float(float f) {
+        std::uint32_t const u = float_bits(f);
+        if ((u & 0x7FFFFFFFu) > 0x7F800000u) {      // NaN - keep it a NaN after truncation
+            return static_cast<std::uint16_t>((u >> 16) | 0x0040u);
+        }
+        return static_cast<std::uint16_t>((u + 0x7FFFu + ((u >> 16) & 1u)) >> 16);
+    }
+};
+
+struct half
+{
+    std::uint16_t bits;
+
+    half() = default;
+
+    explicit half(float f)
+        : bits{from_float(f)} { }
+
+    explicit operator float() const {
+        // move exponent and mantissa into place and rebias the exponent;
+        // infinities and NaNs get the maximal exponent, subnormals are normalized
+        // by a floating point subtraction
+        std::uint32_t const shifted_exp = 0x7C00u << 13;
+        std::uint32_t u = (bits & 0x7FFFu) << 13;
+        std::uint32_t const exp = u & shifted_exp;
+        u += (127u - 15u) << 23;
+        if (exp == shifted_exp) {
+            u += (128u - 16u) << 23;
+        }
+        else if (exp == 0) {
+            u += 1u << 23;
+            u = float_bits(bits_float(u) - bits_float(113u << 23));
+        }
+        return bits_float(u | (std::uint32_t{bits} & 0x8000u) << 16);
+    }
+
+    static std::uint16_t from_float(float f) {
+        std::uint32_t u = float_bits(f);
+        std::uint32_t const sign = u & 0x80000000u;
+        u ^= sign;
+        std::uint32_t h;
+        if (u >= 0x47800000u) {                     // overflow, infinity or NaN
+            h = u > 0x7F800000u ? 0x7E00u : 0x7C00u;
+        }
+        else if (u < 0x38800000u) {                 // subnormal or zero: adding 0.5 aligns the
+            h = float_bits(bits_float(u) + 0.5f)    // mantissa bits at the bottom, rounded by
+                - float_bits(0.5f);                 // the floating point addition
+        }
+        else {
+            u += ((15u - 127u) << 23) + 0xFFFu + ((u >> 13) & 1u);
+            h = u >> 13;
+        }
+        return static_cast<std::uint16_t>(h | sign >> 16);
+    }
+};
+
+
+// packets of float to and from the 16-bit formats
+/* --------------------------------------------------------------------------------------------- */
+#if defined(__AVX512F__)
+
+template<>
+struct PacketConvert<float, bfloat16>
+{
+    static constexpr bool value = true;
+    static __m512 load(bfloat16 const* p) {
+        __m512i const u = _mm512_maskz_cvtepu16_epi32(0xFFFF,
+                            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)));
+        return _mm512_castsi512_ps(_mm512_maskz_slli_epi32(0xFFFF, u, 16));
+    }
+    static void store(bfloat16* p, __m512 v) {
+        // (the masked forms avoid a spurious -Wmaybe-uninitialized from GCC's headers)
+        __m512i const u = _mm512_castps_si512(v);
+        __m512i const upper = _mm512_maskz_srli_epi32(0xFFFF, u, 16);
+        __m512i const lsb = _mm512_and_si512(upper, _mm512_set1_epi32(1));
+        __m512i const rounded = _mm512_maskz_srli_epi32(0xFFFF,
+            _mm512_add_epi32(_mm512_add_epi32(u, _mm512_set1_epi32(0x7FFF)), lsb), 16);
+        __m512i const nan = _mm512_or_si512(upper, _mm512_set1_epi32(0x40));
+        __m512i const h = _mm512_mask_mov_epi32(rounded, _mm512_cmp_ps_mask(v, v, _CMP_UNORD_Q),
+                                                nan);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p),
+                            _mm512_maskz_cvtepi32_epi16(0xFFFF, h));
+    }
+};
+
+template<>
+struct PacketConvert<float, half>
+{
+    static constexpr bool value = true;
+    static __m512 load(half const* p) {
+        return _mm512_maskz_cvtph_ps(0xFFFF,
+                    _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)));
+    }
+    static void store(half* p, __m512 v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p),
+            _mm512_maskz_cvtps_ph(0xFFFF, v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+};
+
+#elif defined(__AVX2__)
+
+template<>
+struct PacketConvert<float, bfloat16>
+{
+    static constexpr bool value = true;
+    static __m256 load(bfloat16 const* p) {
+        __m256i const u = _mm256_cvtepu16_epi32(
+                            _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));
+        return _mm256_castsi256_ps(_mm256_slli_epi32(u, 16));
+    }
+    static void store(bfloat16* p, __m256 v) {
+        __m256i const u = _mm256_castps_si256(v);
+        __m256i const upper = _mm256_srli_epi32(u, 16);
+        __m256i const lsb = _mm256_and_si256(upper, _mm256_set1_epi32(1));
+        __m256i const rounded = _mm256_srli_epi32(
+            _mm256_add_epi32(_mm256_add_epi32(u, _mm256_set1_epi32(0x7FFF)), lsb), 16);
+        __m256i const nan = _mm256_or_si256(upper, _mm256_set1_epi32(0x40));
+        __m256i const h = _mm256_blendv_epi8(rounded, nan,
+                              _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                         _mm_packus_epi32(_mm256_castsi256_si128(h),
+                                          _mm256_extracti128_si256(h, 1)));
+    }
+};
+
+#if defined(__F16C__)
+template<>
+struct PacketConvert<float, half>
+{
+    static constexpr bool value = true;
+    static __m256 load(half const* p) {
+        return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));
+    }
+    static void store(half* p, __m256 v) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                         _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+};
+#endif
+
+#elif defined(__SSE2__) && !defined(__AVX__)
+
+// (half needs F16C; without it its elements are converted one at a time)
+template<>
+struct PacketConvert<float, bfloat16>
+{
+    static constexpr bool value = true;
+    static __m128 load(bfloat16 const* p) {
+        __m128i const u = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(p));
+        return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), u));
+    }
+    static void store(bfloat16* p, __m128 v) {
+        // arithmetic shifts, so that the signed saturation of _mm_packs_epi32 (SSE2 has no
+        // unsigned one) keeps the 16 bits as they are
+        __m128i const u = _mm_castps_si128(v);
+        __m128i const upper = _mm_srai_epi32(u, 16);
+        __m128i const lsb = _mm_and_si128(upper, _mm_set1_epi32(1));
+        __m128i const rounded = _mm_srai_epi32(
+            _mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(0x7FFF)), lsb), 16);
+        __m128i const nan = _mm_or_si128(upper, _mm_set1_epi32(0x40));
+        __m128i const is_nan = _mm_castps_si128(_mm_cmpunord_ps(v, v));
+        __m128i const h = _mm_or_si128(_mm_and_si128(is_nan, nan),
+                                       _mm_andnot_si128(is_nan, rounded));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(h, h));
+    }
+};
+
+#endif
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include "simple_array.hpp"
+#include "expr_packet.hpp"
+#include "float16.hpp"
+
+
+// Array representation storing its elements in a 16-bit format S (bfloat16 or half), but
+// presenting them as floats:
+//   Array<float, Float16Array<bfloat16>> x{n};
+// Expressions over such arrays are ordinary float expressions - reading an element widens
+// it, assigning one rounds it to S. With PacketConvert support for S whole packets are
+// converted while they are loaded and stored, so a streaming expression moves half the
+// bytes of the same expression over float arrays.
+template<typename S, typename Allocator = AlignedAllocator<S>>
+class Float16Array
+{
+public:
+    using value_type = float;
+    using storage_type = S;
+    static constexpr bool packet_access = has_packet_convert_v<float,S>;
+
+    // element access for assignments: converts on store
+    class reference
+    {
+    public:
+        explicit reference(S& s)
+            : s_{s} { }
+
+        reference(reference const&) = default;
+
+        reference& operator=(float v) {
+            s_ = S{v};
+            return *this;
+        }
+
+        reference& operator=(reference const& r) {
+            return *this = static_cast<float>(r);
+        }
+
+        operator float() const { return static_cast<float>(s_); }
+
+    private:
+        S& s_;
+    };
+
+    // create array with initial size (all elements zero)
+    explicit Float16Array(std::size_t s, Allocator const& alloc = Allocator{})
+        : elements_{s, alloc} { }
+
+    Float16Array(std::size_t s, uninitialized_t, Allocator const& alloc = Allocator{})
+        : elements_{s, uninitialized, alloc} { }
+
+    std::size_t size() const {
+        return elements_.size();
+    }
+
+    float operator[](std::size_t idx) const {
+        return static_cast<float>(elements_[idx]);
+    }
+
+    reference operator[](std::size_t idx) {
+        return reference{elements_[idx]};
+    }
+
+    // packet access only with a packet conversion for S
+    template<typename S2 = S, typename = std::enable_if_t<has_packet_convert_v<float,S2>>>
+    typename Packet<float>::type load_packet(std::size_t idx) const {
+        return PacketConvert<float,S>::load(elements_.data() + idx);
+    }
+
+    template<typename S2 = S, typename = std::enable_if_t<has_packet_convert_v<float,S2>>>
+    void store_packet(std::size_t idx, typename Packet<float>::type v) {
+        PacketConvert<float,S>::store(elements_.data() + idx, v);
+    }
+
+    // the stored elements (deliberately not data(), which would claim contiguous floats)
+    S const* storage() const { return elements_.data(); }
+    S* storage() { return elements_.data(); }
+
+private:
+    SArray<S, Allocator> elements_;
+};
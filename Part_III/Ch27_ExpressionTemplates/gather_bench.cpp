@@ -0,0 +1,68 @@
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "bench_util.hpp"
+
+
+// r = x[y] for different index patterns: the gather engine (Array::operator=) against
+// the plain element-by-element loop, and the gather with software prefetching at a range of
+// distances (GatherPolicy::prefetch_distance, off by default). Random indices into an array
+// much larger than the last level cache are where prefetching can pay off - how much
+// depends on how many independent misses the core already keeps in flight on its own.
+int main(int argc, char* argv[])
+{
+    std::size_t const n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16'000'000;
+    std::cout << "elements: " << n << '\n';
+
+    Array<double> x{n}, r{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = static_cast<double>(i);
+    }
+
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<int> shuffled{order};
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937{42});
+
+    auto const fill = [&](Array<int>& y, auto&& index_of){
+        for (std::size_t i = 0; i < n; ++i) {
+            y[i] = index_of(i);
+        }
+    };
+    Array<int> contiguous{n}, strided{n}, sorted{n}, random{n};
+    fill(contiguous, [&](std::size_t i){ return order[i]; });
+    fill(strided, [&](std::size_t i){ return order[(i * 16) % n]; });
+    fill(random, [&](std::size_t i){ return shuffled[i]; });
+    std::sort(shuffled.begin(), shuffled.begin() + static_cast<std::ptrdiff_t>(n / 2));
+    fill(sorted, [&](std::size_t i){ return shuffled[i / 2]; });  // sorted, with repeats
+
+    auto const per_elem = [&](double ns){ return ns / static_cast<double>(n); };
+    auto const run = [&](char const* name, Array<int> const& y){
+        auto const plain = time_ns([&]{
+            eval_scalar(r.rep(), x[y].rep(), 0, n);
+            do_not_optimize(r[0]);
+        });
+        auto const engine = time_ns([&]{
+            r = x[y];
+            do_not_optimize(r[0]);
+        });
+        std::cout << name << "plain " << per_elem(plain) << " ns/elem, engine "
+                  << per_elem(engine) << " ns/elem, prefetch distance";
+        for (std::size_t const distance : {16u, 32u, 64u, 128u}) {
+            auto const prefetched = time_ns([&]{
+                eval_gather<double>(r.rep(), x[y].rep(), 0, n, GatherPolicy{distance});
+                do_not_optimize(r[0]);
+            });
+            std::cout << ' ' << distance << ": " << per_elem(prefetched);
+        }
+        std::cout << '\n';
+    };
+    run("contiguous: ", contiguous);
+    run("strided:    ", strided);
+    run("sorted:     ", sorted);
+    run("random:     ", random);
+}
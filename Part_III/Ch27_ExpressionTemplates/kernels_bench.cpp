@@ -0,0 +1,283 @@
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "expr_reduce.hpp"
+#include "expr_stencil.hpp"
+#include "simple_ops.hpp"
+#include "bench_util.hpp"
+
+
+// The benchmark suite of the chapter. Every kernel is computed three ways:
+// - temporaries: SArray with simple_ops.hpp, one temporary array per operator
+// - expression:  Array expression templates, evaluated in a single loop
+// - hand:        a hand written loop over the raw data
+// (and stencil5 a fourth way, shift: the expression with shifted views where they apply)
+// for array sizes from L1-resident (8 KiB per array) up to DRAM-resident.
+//
+// The output is CSV, one line per kernel, variant and size:
+//   kernel,variant,elements,ns_per_elem,gb_per_s,allocs_per_eval
+// GB/s counts the essential memory traffic of the kernel (every input read once, every
+// output written once), so the extra traffic of temporaries shows up as a lower rate.
+//
+// usage: kernels_bench [max_elements [output.csv]]
+// `cmake --build . --target bench` runs it with the defaults into kernels_bench.csv.
+
+using Vec = SArray<double, CountingAllocator<double>>;
+using Vector = Array<double, Vec>;
+using Indices = Array<int, SArray<int, CountingAllocator<int>>>;
+
+
+struct Measurement
+{
+    double ns_per_elem;
+    double allocs_per_eval;
+};
+
+// time kernel() repeated often enough to run for a few milliseconds
+template<typename F>
+Measurement measure(std::size_t n, F&& kernel)
+{
+    std::size_t const reps = std::max<std::size_t>(1, (std::size_t{1} << 24) / n);
+    int const rounds = 3;
+    std::size_t const allocs_before = AllocationCounter::count;
+    double const ns = time_ns([&]{
+        for (std::size_t r = 0; r < reps; ++r) {
+            kernel();
+        }
+    }, rounds);
+    auto const evals = static_cast<double>(reps) * rounds;
+    return {ns / (static_cast<double>(reps) * static_cast<double>(n)),
+            static_cast<double>(AllocationCounter::count - allocs_before) / evals};
+}
+
+class Report
+{
+public:
+    explicit Report(std::ostream& out)
+        : out_{out}
+    {
+        out_ << "kernel,variant,elements,ns_per_elem,gb_per_s,allocs_per_eval\n";
+    }
+
+    // bytes: essential memory traffic per element
+    void add(char const* kernel, char const* variant, std::size_t n, std::size_t bytes,
+             Measurement const& m)
+    {
+        out_ << kernel << ',' << variant << ',' << n << ',' << m.ns_per_elem << ','
+             << static_cast<double>(bytes) / m.ns_per_elem << ',' << m.allocs_per_eval << '\n';
+    }
+
+private:
+    std::ostream& out_;
+};
+
+// the three variants must agree (up to rounding - the expressions use fused multiply-adds
+// and several accumulators)
+bool agree(double a, double b)
+{
+    return std::abs(a - b) <= 1e-9 * std::max({1.0, std::abs(a), std::abs(b)});
+}
+
+template<typename A, typename B>
+bool agree(A const& a, B const& b, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!agree(a[i], b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double total(Vec const& a)
+{
+    double s = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        s += a[i];
+    }
+    return s;
+}
+
+// a[idx] materialized into a new array
+Vec take(Vec const& a, Indices const& idx)
+{
+    Vec result{idx.size(), uninitialized};
+    for (std::size_t i = 0; i < idx.size(); ++i) {
+        result[i] = a[static_cast<std::size_t>(idx[i])];
+    }
+    return result;
+}
+
+
+struct Data
+{
+    explicit Data(std::size_t n)
+        : sx{n}, sy{n}, sr{n}, x{n}, y{n}, r{n}, h{n}
+    {
+        for (std::size_t i = 0; i < n; ++i) {
+            sx[i] = x[i] = std::sin(static_cast<double>(i));
+            sy[i] = y[i] = 0.5 + 0.25 * std::cos(static_cast<double>(i));
+        }
+    }
+
+    Vec sx, sy, sr;     // temporaries
+    Vector x, y, r;     // expression
+    Vector h;           // result of the hand written loops
+};
+
+// z = a*x + y
+bool axpy(Data& d, std::size_t n, Report& report)
+{
+    double const a = 1.5;
+    report.add("axpy", "temporaries", n, 24, measure(n, [&]{
+        d.sr = a*d.sx + d.sy;
+    }));
+    report.add("axpy", "expression", n, 24, measure(n, [&]{
+        d.r = a*d.x + d.y;
+    }));
+    double const* x = d.x.rep().data();
+    double const* y = d.y.rep().data();
+    double* h = d.h.rep().data();
+    report.add("axpy", "hand", n, 24, measure(n, [&]{
+        for (std::size_t i = 0; i < n; ++i) {
+            h[i] = a*x[i] + y[i];
+        }
+        do_not_optimize(h[0]);
+    }));
+    return agree(d.sr, d.r, n) && agree(d.r, d.h, n);
+}
+
+// cubic polynomial in Horner form
+bool polynomial(Data& d, std::size_t n, Report& report)
+{
+    double const c0 = 1.0, c1 = -0.5, c2 = 0.25, c3 = -0.125;
+    report.add("polynomial", "temporaries", n, 16, measure(n, [&]{
+        d.sr = ((c3*d.sx + c2)*d.sx + c1)*d.sx + c0;
+    }));
+    report.add("polynomial", "expression", n, 16, measure(n, [&]{
+        d.r = ((c3*d.x + c2)*d.x + c1)*d.x + c0;
+    }));
+    double const* x = d.x.rep().data();
+    double* h = d.h.rep().data();
+    report.add("polynomial", "hand", n, 16, measure(n, [&]{
+        for (std::size_t i = 0; i < n; ++i) {
+            h[i] = ((c3*x[i] + c2)*x[i] + c1)*x[i] + c0;
+        }
+        do_not_optimize(h[0]);
+    }));
+    return agree(d.sr, d.r, n) && agree(d.r, d.h, n);
+}
+
+// 5-point smoothing stencil on a periodic square grid
+// The expression reaches the neighbours through index arrays (gathers), and the temporaries
+// version materializes the shifted grids.
+// The shift variant reaches north and south by shifting the grid a row, wrapping around the
+// whole array (expr_stencil.hpp). West and east wrap around within the row, which no shift
+// of the flat array does, so it still gathers them (as fast as selecting the first and last
+// columns from other shifts by where() with AVX packets, faster with SSE2).
+bool stencil(Data& d, std::size_t n, Report& report)
+{
+    auto const w = static_cast<std::size_t>(std::sqrt(static_cast<double>(n)));
+    if (w * w != n) {
+        return true;    // only square grids
+    }
+    Indices west{n}, east{n}, north{n}, south{n};
+    for (std::size_t row = 0; row < w; ++row) {
+        for (std::size_t col = 0; col < w; ++col) {
+            std::size_t const i = row * w + col;
+            west[i] = static_cast<int>(row * w + (col + w - 1) % w);
+            east[i] = static_cast<int>(row * w + (col + 1) % w);
+            north[i] = static_cast<int>((row + w - 1) % w * w + col);
+            south[i] = static_cast<int>((row + 1) % w * w + col);
+        }
+    }
+    auto const stride = static_cast<std::ptrdiff_t>(w);
+
+    double const c = 0.125, center = 0.5;
+    report.add("stencil5", "temporaries", n, 16, measure(n, [&]{
+        d.sr = c*(take(d.sx, west) + take(d.sx, east) + take(d.sx, north) + take(d.sx, south))
+               + center*d.sx;
+    }));
+    report.add("stencil5", "expression", n, 16, measure(n, [&]{
+        d.r = c*(d.x[west] + d.x[east] + d.x[north] + d.x[south]) + center*d.x;
+    }));
+    bool const gathered = agree(d.sr, d.r, n);
+    report.add("stencil5", "shift", n, 16, measure(n, [&]{
+        d.r = c*(d.x[west] + d.x[east]
+                 + shift(d.x, -stride, boundary_wrap) + shift(d.x, stride, boundary_wrap))
+              + center*d.x;
+    }));
+    double const* x = d.x.rep().data();
+    double* h = d.h.rep().data();
+    report.add("stencil5", "hand", n, 16, measure(n, [&]{
+        for (std::size_t row = 0; row < w; ++row) {
+            double const* above = x + (row + w - 1) % w * w;
+            double const* here = x + row * w;
+            double const* below = x + (row + 1) % w * w;
+            double* out = h + row * w;
+            out[0] = c*(here[w - 1] + here[1] + above[0] + below[0]) + center*here[0];
+            for (std::size_t col = 1; col + 1 < w; ++col) {
+                out[col] = c*(here[col - 1] + here[col + 1] + above[col] + below[col])
+                           + center*here[col];
+            }
+            out[w - 1] = c*(here[w - 2] + here[0] + above[w - 1] + below[w - 1])
+                         + center*here[w - 1];
+        }
+        do_not_optimize(h[0]);
+    }));
+    return gathered && agree(d.sr, d.r, n) && agree(d.r, d.h, n);
+}
+
+// x.y / (|x| |y|)
+bool normalized_dot(Data& d, std::size_t n, Report& report)
+{
+    double ts = 0.0, es = 0.0, hs = 0.0;
+    report.add("normalized_dot", "temporaries", n, 16, measure(n, [&]{
+        ts = total(d.sx*d.sy) / std::sqrt(total(d.sx*d.sx) * total(d.sy*d.sy));
+        do_not_optimize(ts);
+    }));
+    report.add("normalized_dot", "expression", n, 16, measure(n, [&]{
+        es = dot(d.x, d.y) / std::sqrt(dot(d.x, d.x) * dot(d.y, d.y));
+        do_not_optimize(es);
+    }));
+    double const* x = d.x.rep().data();
+    double const* y = d.y.rep().data();
+    report.add("normalized_dot", "hand", n, 16, measure(n, [&]{
+        double xy = 0.0, xx = 0.0, yy = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            xy += x[i]*y[i];
+            xx += x[i]*x[i];
+            yy += y[i]*y[i];
+        }
+        hs = xy / std::sqrt(xx * yy);
+        do_not_optimize(hs);
+    }));
+    return agree(ts, es) && agree(es, hs);
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::size_t const max_n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::size_t{1} << 24;
+    std::ofstream file;
+    if (argc > 2) {
+        file.open(argv[2]);
+    }
+    Report report{argc > 2 ? file : std::cout};
+    std::cerr << "packet width (double): " << Packet<double>::size << '\n';
+
+    // powers of 4, so that the stencil grids are square
+    for (std::size_t n = 1024; n <= max_n; n *= 4) {
+        Data data{n};
+        bool const ok = axpy(data, n, report) && polynomial(data, n, report)
+                        && stencil(data, n, report) && normalized_dot(data, n, report);
+        if (!ok) {
+            std::cerr << "results differ for " << n << " elements\n";
+            return EXIT_FAILURE;
+        }
+    }
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "expr_packet.hpp"
+
+// Array representations over memory-mapped files (POSIX), for arrays larger than memory:
+//   Array<double, MappedArray<double>> a{MappedArray<double>{"a.bin"}}, b{...}, c{...};
+//   Array<double, MappedOutput<double>> out{MappedOutput<double>{"out.bin", a.size()}};
+//   out = a*b + c;
+// The files hold the raw elements. Both representations declare themselves `streamed`,
+// so such an assignment is evaluated in chunks (see expr_stream.hpp): the next chunk of
+// every file is requested ahead (MADV_WILLNEED) and the pages of the finished chunk are
+// dropped from the process (MADV_DONTNEED) - the resident set stays at a few chunks
+// however large the files are. Errors of the system calls throw std::system_error.
+
+
+// a file mapped into memory, read-only or read-write
+class MappedFile
+{
+public:
+    enum class Mode { read, create };
+
+    // map the whole file at path (read), or create / truncate it with the given size
+    MappedFile(std::string const& path, Mode mode, std::size_t bytes = 0)
+    {
+        bool const writable = mode == Mode::create;
+        fd_ = ::open(path.c_str(), writable ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+        if (fd_ < 0) {
+            fail("open " + path);
+        }
+        if (writable) {
+            if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+                fail("ftruncate " + path);
+            }
+        }
+        else {
+            struct stat st{};
+            if (::fstat(fd_, &st) != 0) {
+                fail("fstat " + path);
+            }
+            bytes = static_cast<std::size_t>(st.st_size);
+        }
+        bytes_ = bytes;
+        if (bytes_ != 0) {
+            void* const p = ::mmap(nullptr, bytes_, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                                   MAP_SHARED, fd_, 0);
+            if (p == MAP_FAILED) {
+                fail("mmap " + path);
+            }
+            data_ = static_cast<unsigned char*>(p);
+            ::madvise(data_, bytes_, MADV_SEQUENTIAL);
+        }
+    }
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    MappedFile(MappedFile&& orig) noexcept
+        : fd_{std::exchange(orig.fd_, -1)},
+          data_{std::exchange(orig.data_, nullptr)},
+          bytes_{std::exchange(orig.bytes_, 0)}
+        { }
+
+    MappedFile& operator=(MappedFile&& orig) noexcept
+    {
+        if (&orig != this) {
+            close();
+            fd_ = std::exchange(orig.fd_, -1);
+            data_ = std::exchange(orig.data_, nullptr);
+            bytes_ = std::exchange(orig.bytes_, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    unsigned char* data() const { return data_; }
+    std::size_t bytes() const { return bytes_; }
+
+    // the bytes [first, last) will be needed soon - start reading them
+    void will_need(std::size_t first, std::size_t last) const {
+        first = page_floor(first);
+        if (first < last && last <= bytes_) {
+            ::madvise(data_ + first, last - first, MADV_WILLNEED);
+        }
+    }
+
+    // the bytes [first, last) are done with - unmap their pages from the process
+    // (they stay in the page cache, written pages are still written to the file);
+    // a partial page at the end is kept, the next range continues on it
+    void release(std::size_t first, std::size_t last) const {
+        first = page_floor(first);
+        last = last < bytes_ ? page_floor(last) : bytes_;
+        if (first < last) {
+            ::madvise(data_ + first, last - first, MADV_DONTNEED);
+        }
+    }
+
+    // write the changes to the file now
+    void flush() const {
+        if (data_ != nullptr && ::msync(data_, bytes_, MS_SYNC) != 0) {
+            throw_error("msync");
+        }
+    }
+
+    static std::size_t page_size() {
+        static std::size_t const size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+private:
+    static std::size_t page_floor(std::size_t offset) {
+        return offset / page_size() * page_size();
+    }
+
+    [[noreturn]] static void throw_error(std::string const& what) {
+        throw std::system_error{errno, std::generic_category(), what};
+    }
+
+    // (in the constructor, which does not complete)
+    [[noreturn]] void fail(std::string const& what) {
+        int const error = errno;
+        close();
+        errno = error;
+        throw_error(what);
+    }
+
+    void close() {
+        if (data_ != nullptr) {
+            ::munmap(data_, bytes_);
+            data_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int fd_{-1};
+    unsigned char* data_{nullptr};
+    std::size_t bytes_{0};
+};
+
+
+// read-only array of the elements stored in a file
+template<typename T>
+class MappedArray
+{
+public:
+    using value_type = T;
+    static constexpr bool packet_access = true;
+    static constexpr bool streamed = true;
+
+    explicit MappedArray(std::string const& path)
+        : file_{path, MappedFile::Mode::read}, size_{file_.bytes() / sizeof(T)} { }
+
+    std::size_t size() const { return size_; }
+
+    T const& operator[](std::size_t idx) const {
+        return data()[idx];
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Packet<T>::load(data() + idx);
+    }
+
+    T const* data() const { return reinterpret_cast<T const*>(file_.data()); }
+
+    // chunked access, see expr_stream.hpp
+    void will_need(std::size_t first, std::size_t last) const {
+        file_.will_need(first * sizeof(T), last * sizeof(T));
+    }
+
+    void release(std::size_t first, std::size_t last) const {
+        file_.release(first * sizeof(T), last * sizeof(T));
+    }
+
+private:
+    MappedFile file_;
+    std::size_t size_;
+};
+
+
+// array of n elements written through to a file (created, or truncated, with that size)
+template<typename T>
+class MappedOutput
+{
+public:
+    using value_type = T;
+    static constexpr bool packet_access = true;
+    static constexpr bool streamed = true;
+
+    MappedOutput(std::string const& path, std::size_t n)
+        : file_{path, MappedFile::Mode::create, n * sizeof(T)}, size_{n} { }
+
+    std::size_t size() const { return size_; }
+
+    T const& operator[](std::size_t idx) const {
+        return data()[idx];
+    }
+
+    T& operator[](std::size_t idx) {
+        return data()[idx];
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Packet<T>::load(data() + idx);
+    }
+
+    void store_packet(std::size_t idx, typename Packet<T>::type v) {
+        Packet<T>::store(data() + idx, v);
+    }
+
+    T const* data() const { return reinterpret_cast<T const*>(file_.data()); }
+    T* data() { return reinterpret_cast<T*>(file_.data()); }
+
+    void will_need(std::size_t first, std::size_t last) const {
+        file_.will_need(first * sizeof(T), last * sizeof(T));
+    }
+
+    void release(std::size_t first, std::size_t last) const {
+        file_.release(first * sizeof(T), last * sizeof(T));
+    }
+
+    // write the elements to the file now (otherwise the system writes them eventually)
+    void flush() const {
+        file_.flush();
+    }
+
+private:
+    MappedFile file_;
+    std::size_t size_;
+};
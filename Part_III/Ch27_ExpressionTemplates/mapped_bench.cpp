@@ -0,0 +1,109 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "mapped_array.hpp"
+#include "bench_util.hpp"
+
+
+// out = a*b + c over files of doubles, by how the inputs get into memory:
+// - loaded: the files are read into SArrays first
+// - mapped: the expression reads the memory-mapped files directly and writes through to
+//   a mapped output file, a chunk at a time
+// For each the time and the peak resident set size (VmHWM, reset before each run where the
+// kernel allows it) are reported. The peak of the mapped version does not grow with
+// the file size.
+//
+// usage: mapped_bench [elements [directory]]
+
+// peak resident set size in MiB
+double peak_rss_mib()
+{
+    std::ifstream status{"/proc/self/status"};
+    for (std::string line; std::getline(status, line); ) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::strtod(line.c_str() + 6, nullptr) / 1024.0;
+        }
+    }
+    return 0.0;
+}
+
+void reset_peak_rss()
+{
+    std::ofstream{"/proc/self/clear_refs"} << "5";
+}
+
+// write n elements, f(i), to a file - a block at a time
+template<typename F>
+void write_file(std::string const& path, std::size_t n, F f)
+{
+    std::ofstream out{path, std::ios::binary};
+    std::vector<double> block(1u << 16);
+    for (std::size_t first = 0; first < n; first += block.size()) {
+        std::size_t const count = std::min(block.size(), n - first);
+        for (std::size_t i = 0; i < count; ++i) {
+            block[i] = f(first + i);
+        }
+        out.write(reinterpret_cast<char const*>(block.data()),
+                  static_cast<std::streamsize>(count * sizeof(double)));
+    }
+}
+
+void load_file(std::string const& path, Array<double>& a)
+{
+    std::ifstream in{path, std::ios::binary};
+    in.read(reinterpret_cast<char*>(a.rep().data()),
+            static_cast<std::streamsize>(a.size() * sizeof(double)));
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t const n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32'000'000;
+    std::string const dir = argc > 2 ? argv[2] : ".";
+    std::string const a_path = dir + "/mapped_a.bin", b_path = dir + "/mapped_b.bin",
+                      c_path = dir + "/mapped_c.bin", out_path = dir + "/mapped_out.bin";
+    std::cout << "elements: " << n << " (" << static_cast<double>(n * sizeof(double)) / (1 << 20)
+              << " MiB per file)\n";
+
+    write_file(a_path, n, [](std::size_t i){ return std::sin(static_cast<double>(i)); });
+    write_file(b_path, n, [](std::size_t i){ return 1.0 / static_cast<double>(i + 1); });
+    write_file(c_path, n, [](std::size_t i){ return static_cast<double>(i % 10); });
+
+    double check = 0.0;
+    {
+        reset_peak_rss();
+        auto const ns = time_ns([&]{
+            Array<double> a{n, uninitialized}, b{n, uninitialized}, c{n, uninitialized},
+                          out{n, uninitialized};
+            load_file(a_path, a);
+            load_file(b_path, b);
+            load_file(c_path, c);
+            out = a*b + c;
+            check = out[n - 1];
+        }, 1);
+        std::cout << "loaded: " << ns / 1e6 << " ms, peak RSS " << peak_rss_mib() << " MiB\n";
+    }
+    {
+        reset_peak_rss();
+        bool same = false;
+        auto const ns = time_ns([&]{
+            Array<double, MappedArray<double>> a{MappedArray<double>{a_path}},
+                                               b{MappedArray<double>{b_path}},
+                                               c{MappedArray<double>{c_path}};
+            Array<double, MappedOutput<double>> out{MappedOutput<double>{out_path, a.size()}};
+            out = a*b + c;
+            same = out[n - 1] == check;
+        }, 1);
+        std::cout << "mapped: " << ns / 1e6 << " ms, peak RSS " << peak_rss_mib() << " MiB"
+                  << (same ? "" : " (wrong result)") << '\n';
+    }
+
+    for (auto const& path : {a_path, b_path, c_path, out_path}) {
+        std::remove(path.c_str());
+    }
+}
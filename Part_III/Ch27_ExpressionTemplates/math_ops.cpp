@@ -0,0 +1,69 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+
+
+// compare an expression result against a hand written loop
+template<typename R, typename F>
+double max_error(Array<double,R> const& result, F reference)
+{
+    double err = 0.0;
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        err = std::max(err, std::abs(result[i] - reference(i)));
+    }
+    return err;
+}
+
+// can the expression an Array is built on be evaluated a packet at a time
+template<typename A>
+constexpr bool is_packet_kernel = is_packet_accessible_v<
+    std::decay_t<decltype(std::declval<A>().rep())>, double>;
+
+int main()
+{
+    std::size_t const n = 1003;     // not a multiple of any packet size - exercises the tail
+    Array<double> x{n}, y{n}, r{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = std::sin(static_cast<double>(i));
+        y[i] = std::cos(static_cast<double>(i)) + 0.5;
+    }
+
+    // every node of these kernels works a packet at a time, so each is a single SIMD loop
+    using Clamp = decltype(min(max(x, -0.5), 0.5));
+    using RelDiff = decltype((x - y) / (abs(x) + abs(y) + 1e-12));
+    using Select = decltype(where(x > y, sqrt(abs(x)), -y));
+    static_assert(is_packet_kernel<Clamp>);
+    static_assert(is_packet_kernel<RelDiff>);
+    static_assert(is_packet_kernel<Select>);
+
+    r = min(max(x, -0.5), 0.5);
+    std::cout << "clamp:            "
+              << max_error(r, [&](std::size_t i){ return std::clamp(x[i], -0.5, 0.5); }) << '\n';
+
+    r = (x - y) / (abs(x) + abs(y) + 1e-12);
+    std::cout << "relative diff:    " << max_error(r, [&](std::size_t i){
+        return (x[i] - y[i]) / (std::abs(x[i]) + std::abs(y[i]) + 1e-12); }) << '\n';
+
+    r = where(x > y, sqrt(abs(x)), -y);
+    std::cout << "where:            " << max_error(r, [&](std::size_t i){
+        return x[i] > y[i] ? std::sqrt(std::abs(x[i])) : -y[i]; }) << '\n';
+
+    // exp and log have no packet versions - one element at a time, but still one loop
+    r = 1.0 / (1.0 + exp(-x));
+    std::cout << "logistic:         " << max_error(r, [&](std::size_t i){
+        return 1.0 / (1.0 + std::exp(-x[i])); }) << '\n';
+
+    r = log(1.0 + exp(x)) - x / 2.0;
+    std::cout << "softplus - x/2:   " << max_error(r, [&](std::size_t i){
+        return std::log(1.0 + std::exp(x[i])) - x[i] / 2.0; }) << '\n';
+
+    // comparisons can also be stored as mask arrays
+    Array<bool> mask{n};
+    mask = x <= y;
+    r = where(mask, x, 0.0);
+    std::cout << "where(mask):      " << max_error(r, [&](std::size_t i){
+        return x[i] <= y[i] ? x[i] : 0.0; }) << '\n';
+}
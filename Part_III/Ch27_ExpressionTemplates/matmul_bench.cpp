@@ -0,0 +1,76 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "expr_matrix.hpp"
+#include "expr_gemm.hpp"
+#include "bench_util.hpp"
+
+
+// C = A*B for square row-major matrices of 64 to 4096 rows: the blocked, register-tiled
+// product of expr_gemm.hpp against the naive triple loop. The naive loop takes minutes for
+// the large sizes, so by default it only runs up to 1024.
+//
+// usage: matmul_bench [max_n [max_naive_n]]
+void naive(double const* a, double const* b, double* c, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            double s = 0.0;
+            for (std::size_t p = 0; p < n; ++p) {
+                s += a[i * n + p] * b[p * n + j];
+            }
+            c[i * n + j] = s;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t const max_n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    std::size_t const max_naive = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+    std::cout << "packet width (double): " << Packet<double>::size
+              << ", micro-kernel " << GemmKernel<double>::mr << 'x'
+              << GemmKernel<double>::nr << '\n';
+
+    for (std::size_t n = 64; n <= max_n; n *= 2) {
+        Matrix<double> a{n, n}, b{n, n}, c{n, n}, r{n, n};
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                a(i, j) = std::sin(static_cast<double>(i + 2 * j));
+                b(i, j) = std::cos(static_cast<double>(3 * i + j));
+            }
+        }
+
+        // repeat small products so that every measurement runs for a while
+        auto const flops = 2.0 * std::pow(static_cast<double>(n), 3);
+        int const reps = std::max(1, static_cast<int>(1e8 / flops));
+        auto const gflops = [&](double ns){ return flops * reps / ns; };
+
+        auto const blocked = time_ns([&]{
+            for (int i = 0; i < reps; ++i) {
+                c = a*b;
+                do_not_optimize(c(0, 0));
+            }
+        }, 3);
+        std::cout << "n = " << n << ": blocked " << gflops(blocked) << " GFLOP/s";
+
+        if (n <= max_naive) {
+            auto const plain = time_ns([&]{
+                for (int i = 0; i < reps; ++i) {
+                    naive(a.rep().data(), b.rep().data(), r.rep().data(), n);
+                    do_not_optimize(r(0, 0));
+                }
+            }, n <= 256 ? 3 : 1);
+            double err = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t j = 0; j < n; ++j) {
+                    err = std::max(err, std::abs(c(i, j) - r(i, j)));
+                }
+            }
+            std::cout << ", naive " << gflops(plain) << " GFLOP/s, speedup " << plain / blocked
+                      << ", max difference " << err;
+        }
+        std::cout << '\n';
+    }
+}
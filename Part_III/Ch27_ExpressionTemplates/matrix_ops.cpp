@@ -0,0 +1,87 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include "expr_ops.hpp"
+#include "expr_matrix.hpp"
+#include "expr_gemm.hpp"
+
+
+using RowMatrix = Matrix<double>;
+using ColMatrix = Matrix<double, SArray<double>, ColMajor>;
+
+template<typename M, typename F>
+double max_error(M const& result, F reference)
+{
+    double err = 0.0;
+    for (std::size_t i = 0; i < result.rows(); ++i) {
+        for (std::size_t j = 0; j < result.cols(); ++j) {
+            err = std::max(err, std::abs(result(i, j) - reference(i, j)));
+        }
+    }
+    return err;
+}
+
+template<typename MA, typename MB>
+double product(MA const& a, MB const& b, std::size_t i, std::size_t j)
+{
+    double s = 0.0;
+    for (std::size_t p = 0; p < a.cols(); ++p) {
+        s += a(i, p) * b(p, j);
+    }
+    return s;
+}
+
+int main()
+{
+    std::size_t const n = 37, k = 29;   // not multiples of any tile size
+    RowMatrix a{n, k}, b{k, n}, c{n, n}, d{n, n};
+    ColMatrix e{n, n}, f{n, n};
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < k; ++j) {
+            a(i, j) = std::sin(static_cast<double>(i * k + j));
+            b(j, i) = std::cos(static_cast<double>(i + 3 * j));
+        }
+        for (std::size_t j = 0; j < n; ++j) {
+            d(i, j) = static_cast<double>(i) - static_cast<double>(j);
+            e(i, j) = 0.5 * static_cast<double>(i * j);
+        }
+    }
+
+    // elementwise, same layout: the A_Add / A_Mult nodes of Array, a packet loop
+    c = 2.0*d + hadamard(d, d);
+    std::cout << "2d + d.d:         " << max_error(c, [&](std::size_t i, std::size_t j){
+        return 2.0*d(i, j) + d(i, j)*d(i, j); }) << '\n';
+
+    // mixed layouts and transposes
+    c = d - e;
+    std::cout << "d - e:            " << max_error(c, [&](std::size_t i, std::size_t j){
+        return d(i, j) - e(i, j); }) << '\n';
+    f = transpose(d) + e;
+    std::cout << "d^T + e:          " << max_error(f, [&](std::size_t i, std::size_t j){
+        return d(j, i) + e(i, j); }) << '\n';
+
+    // products
+    c = a*b;
+    std::cout << "a b:              " << max_error(c, [&](std::size_t i, std::size_t j){
+        return product(a, b, i, j); }) << '\n';
+    f = transpose(b)*transpose(a);
+    std::cout << "b^T a^T:          " << max_error(f, [&](std::size_t i, std::size_t j){
+        return product(a, b, j, i); }) << '\n';
+    c = (2.0*a)*(b + transpose(a));
+    std::cout << "2a (b + a^T):     " << max_error(c, [&](std::size_t i, std::size_t j){
+        double s = 0.0;
+        for (std::size_t p = 0; p < k; ++p) {
+            s += 2.0*a(i, p) * (b(p, j) + a(j, p));
+        }
+        return s; }) << '\n';
+
+    // the destination as an operand is computed through a temporary
+    RowMatrix g{d};
+    d = d*transpose(d);
+    std::cout << "d = d d^T:        " << max_error(d, [&](std::size_t i, std::size_t j){
+        return product(g, transpose(g), i, j); }) << '\n';
+
+    RowMatrix h = a*b;
+    std::cout << "h = a b:          " << max_error(h, [&](std::size_t i, std::size_t j){
+        return product(a, b, i, j); }) << '\n';
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <cstdlib>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "simple_ops.hpp"
+#include "bench_util.hpp"
+
+
+// Compare three ways of computing x = 1.2*x + x*y:
+// - SArray with simple_ops.hpp - one temporary array per operator
+// - Array expression template evaluated through the scalar loop
+// - Array expression template evaluated a packet at a time (what Array::operator= does)
+int main(int argc, char* argv[])
+{
+    std::size_t const n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000;
+    std::cout << "elements: " << n << ", packet width (double): "
+              << Packet<double>::size << '\n';
+
+    SArray<double> sx{n}, sy{n};
+    Array<double> x{n}, y{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = x[i] = 1.0 / static_cast<double>(i + 1);
+        sy[i] = y[i] = 0.5;
+    }
+
+    auto const temporaries = time_ns([&]{
+        sx = 1.2*sx + sx*sy;
+        do_not_optimize(sx[0]);
+    });
+
+    auto const scalar = time_ns([&]{
+        // the expression holds references to temporaries, so it must be
+        // evaluated within the full-expression that creates it
+        eval_scalar(x.rep(), (1.2*x + x*y).rep(), 0, n);
+        do_not_optimize(x[0]);
+    });
+
+    auto const packet = time_ns([&]{
+        x = 1.2*x + x*y;
+        do_not_optimize(x[0]);
+    });
+
+    auto const per_elem = [n](double ns){ return ns / static_cast<double>(n); };
+    std::cout << "simple_ops temporaries: " << per_elem(temporaries) << " ns/elem\n"
+              << "expression, scalar:     " << per_elem(scalar) << " ns/elem\n"
+              << "expression, packet:     " << per_elem(packet) << " ns/elem\n";
+}
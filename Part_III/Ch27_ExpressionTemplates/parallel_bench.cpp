@@ -0,0 +1,41 @@
+#include <iostream>
+#include <cstdlib>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "expr_parallel.hpp"
+#include "bench_util.hpp"
+
+
+// Scaling of parallel_assign() for x = 1.2*x + x*y with 1, 2, 4, 8 and 16 threads.
+// Expect close to linear speedup until memory bandwidth is saturated
+// (and no speedup beyond the number of hardware threads of the machine).
+int main(int argc, char* argv[])
+{
+    std::size_t const n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20'000'000;
+    std::cout << "elements: " << n << ", hardware threads: "
+              << std::thread::hardware_concurrency() << '\n';
+
+    Array<double> x{n}, y{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = 1.0 / static_cast<double>(i + 1);
+        y[i] = 0.5;
+    }
+
+    auto const serial = time_ns([&]{
+        x = 1.2*x + x*y;
+        do_not_optimize(x[0]);
+    });
+    std::cout << "serial:     " << serial / static_cast<double>(n) << " ns/elem\n";
+
+    for (std::size_t threads : {1u, 2u, 4u, 8u, 16u}) {
+        ThreadPool pool{threads};
+        ParallelPolicy const policy{pool};
+        auto const parallel = time_ns([&]{
+            parallel_assign(x, 1.2*x + x*y, policy);
+            do_not_optimize(x[0]);
+        });
+        std::cout << "threads " << threads << ": "
+                  << parallel / static_cast<double>(n) << " ns/elem, speedup "
+                  << serial / parallel << '\n';
+    }
+}
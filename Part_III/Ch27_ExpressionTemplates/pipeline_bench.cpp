@@ -0,0 +1,44 @@
+#include <iostream>
+#include <cstdlib>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "expr_pipeline.hpp"
+#include "bench_util.hpp"
+
+
+// a = x*y; b = a + z; c = b*x; - statement by statement against a tiled pipeline.
+// For arrays much larger than the last level cache, the statements take a pass over memory
+// each, while the pipeline reads x, y and z and writes a, b and c once.
+int main(int argc, char* argv[])
+{
+    std::size_t const n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16'000'000;
+    std::cout << "elements: " << n << '\n';
+
+    Array<double> x{n}, y{n}, z{n}, a{n}, b{n}, c{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = 1.0 / static_cast<double>(i + 1);
+        y[i] = 0.5;
+        z[i] = static_cast<double>(i % 7);
+    }
+
+    auto const statements = time_ns([&]{
+        a = x*y;
+        b = a + z;
+        c = b*x;
+        do_not_optimize(c[0]);
+    });
+    double const check = c[n - 1];
+
+    auto const per_elem = [n](double ns){ return ns / static_cast<double>(n); };
+    std::cout << "statements:           " << per_elem(statements) << " ns/elem\n";
+
+    for (std::size_t kib : {32u, 256u, 1024u, 8192u}) {
+        TilePolicy const policy{kib * 1024u};
+        auto const tiled = time_ns([&]{
+            pipeline(assign(a, x*y), assign(b, a + z), assign(c, b*x)).run(policy);
+            do_not_optimize(c[0]);
+        });
+        std::cout << "pipeline, " << kib << " KiB tiles: " << per_elem(tiled) << " ns/elem"
+                  << (c[n - 1] == check ? "" : " (wrong result)") << '\n';
+    }
+}
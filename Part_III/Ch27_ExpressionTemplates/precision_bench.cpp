@@ -0,0 +1,83 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "float16_array.hpp"
+#include "bench_util.hpp"
+
+
+// z = a*x + y over large arrays, by the type the arrays are stored in:
+// - double
+// - float arrays with a double scalar, before mixed precision: copied to double arrays
+//   first, the result copied back
+// - float arrays with a double scalar: a double expression reading floats, the result
+//   narrowed when it is stored
+// - float with a float scalar
+// - bfloat16 and half storage, computed in float
+// The expression is bound by memory bandwidth, so the time follows the bytes per element.
+// The error is the maximal difference to the double result, relative to its largest element.
+
+static_assert(std::is_same_v<decltype(2.5*std::declval<Array<float> const&>()),
+                             Array<double, A_Mult<double, A_Scalar<double>,
+                                                  A_Convert<double, SArray<float>>>>>);
+static_assert(std::is_same_v<decltype(2.5f*std::declval<Array<float, Float16Array<half>> const&>()),
+                             Array<float, A_Mult<float, A_Scalar<float>, Float16Array<half>>>>);
+
+int main(int argc, char* argv[])
+{
+    std::size_t const n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16'000'000;
+    std::cout << "elements: " << n << '\n';
+
+    Array<double> xd{n}, yd{n}, zd{n}, td{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        xd[i] = std::sin(static_cast<double>(i));
+        yd[i] = std::cos(static_cast<double>(i) * 0.5);
+    }
+    Array<float> xf{n}, yf{n}, zf{n};
+    Array<float, Float16Array<bfloat16>> xb{n}, yb{n}, zb{n};
+    Array<float, Float16Array<half>> xh{n}, yh{n}, zh{n};
+    xf = xd; yf = yd;
+    xb = xd; yb = yd;
+    xh = xd; yh = yd;
+
+    auto const report = [n, &zd](char const* name, double ns, std::size_t bytes,
+                                 auto const& z) {
+        double err = 0.0, scale = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            double v = zd[i];
+            if constexpr (!std::is_same_v<std::decay_t<decltype(z[i])>, double>) {
+                v = static_cast<double>(z[i]);
+            }
+            err = std::max(err, std::abs(v - zd[i]));
+            scale = std::max(scale, std::abs(zd[i]));
+        }
+        double const per_elem = ns / static_cast<double>(n);
+        std::cout << name << per_elem << " ns/elem, " << static_cast<double>(bytes) / per_elem
+                  << " GB/s, error " << err / scale << '\n';
+    };
+
+    auto const t_double = time_ns([&]{ zd = 2.5*xd + yd; do_not_optimize(zd[0]); });
+    report("double:                 ", t_double, 3 * sizeof(double), zd);
+
+    auto const t_copies = time_ns([&]{
+        xd = xf; yd = yf;
+        td = 2.5*xd + yd;
+        zf = td;
+        do_not_optimize(zf[0]);
+    });
+    report("float via double copies: ", t_copies, 4 * sizeof(float) + 5 * sizeof(double), zf);
+
+    auto const t_mixed = time_ns([&]{ zf = 2.5*xf + yf; do_not_optimize(zf[0]); });
+    report("float, double scalar:   ", t_mixed, 3 * sizeof(float), zf);
+
+    auto const t_float = time_ns([&]{ zf = 2.5f*xf + yf; do_not_optimize(zf[0]); });
+    report("float:                  ", t_float, 3 * sizeof(float), zf);
+
+    auto const t_bf16 = time_ns([&]{ zb = 2.5f*xb + yb; do_not_optimize(zb[0]); });
+    report("bfloat16:               ", t_bf16, 3 * sizeof(bfloat16), zb);
+
+    auto const t_half = time_ns([&]{ zh = 2.5f*xh + yh; do_not_optimize(zh[0]); });
+    report("half:                   ", t_half, 3 * sizeof(half), zh);
+}
@@ -0,0 +1,32 @@
+#include <iostream>
+#include <iomanip>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "expr_reduce.hpp"
+
+
+int main()
+{
+    std::size_t const n = 1'000'001;
+    Array<double> x{n}, y{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = 1.0 / static_cast<double>(i + 1);
+        y[i] = static_cast<double>(i % 7) - 3.0;
+    }
+
+    // no temporary arrays - each reduction walks the expression tree once
+    std::cout << std::setprecision(17)
+              << "sum(1.2*x + x*y) = " << sum(1.2*x + x*y) << '\n'
+              << "dot(x, y)        = " << dot(x, y) << '\n'
+              << "norm2(x)         = " << norm2(x) << '\n'
+              << "min(x*y)         = " << min(x*y) << '\n'
+              << "max(x*y)         = " << max(x*y) << '\n';
+
+    // compensated summation keeps the error independent of n
+    Array<float> f{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        f[i] = 0.1f;
+    }
+    std::cout << "sum of " << n << " * 0.1f: " << sum(f)
+              << " (kahan: " << sum(f, kahan) << ")\n";
+}
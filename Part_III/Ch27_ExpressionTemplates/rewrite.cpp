@@ -0,0 +1,102 @@
+#include <iostream>
+#include <type_traits>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "bench_util.hpp"
+
+
+// number of arithmetic instructions per element the expression tree executes
+// (a fused multiply-add counts as one)
+template<typename E>
+struct ops_per_element : std::integral_constant<int, 0> { };   // leaves
+
+template<typename T, typename OP1, typename OP2>
+struct ops_per_element<A_Add<T,OP1,OP2>>
+    : std::integral_constant<int, 1 + ops_per_element<OP1>::value
+                                    + ops_per_element<OP2>::value> { };
+
+template<typename T, typename OP1, typename OP2>
+struct ops_per_element<A_Mult<T,OP1,OP2>>
+    : std::integral_constant<int, 1 + ops_per_element<OP1>::value
+                                    + ops_per_element<OP2>::value> { };
+
+template<typename T, typename OP1, typename OP2, typename OP3>
+struct ops_per_element<A_FMA<T,OP1,OP2,OP3>>
+    : std::integral_constant<int, 1 + ops_per_element<OP1>::value
+                                    + ops_per_element<OP2>::value
+                                    + ops_per_element<OP3>::value> { };
+
+template<typename T, typename OP, typename Op>
+struct ops_per_element<A_Unary<T,OP,Op>>
+    : std::integral_constant<int, 1 + ops_per_element<OP>::value> { };
+
+// operation count of the tree an Array expression is built on
+template<typename A>
+constexpr int ops_of = ops_per_element<std::decay_t<decltype(std::declval<A>().rep())>>::value;
+
+// ...and of the tree the evaluation loops run over, with shared operands evaluated once
+template<typename T, typename R>
+int evaluated_ops(Array<T,R> const& a)
+{
+    int ops = 0;
+    with_shared(a.rep(), [&](auto const& e) {
+        ops = ops_per_element<std::decay_t<decltype(e)>>::value;
+    });
+    return ops;
+}
+
+int main()
+{
+    std::size_t const n = 4096;     // L1/L2 resident, so that arithmetic - not memory - matters
+    Array<double> x{n}, y{n}, r{n};
+    Array<double> a0{n}, a1{n}, a2{n}, a3{n};
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = 1.0 / static_cast<double>(i + 1);
+        y[i] = 0.5;
+        a0[i] = 1.0; a1[i] = 0.5; a2[i] = 0.25; a3[i] = 0.125;
+    }
+
+    // constant folding: 2*(3*x) is a single multiplication
+    using Folded = decltype(2.0*(3.0*x));
+    static_assert(std::is_same_v<Folded,
+                                 Array<double, A_Mult<double, A_Scalar<double>, SArray<double>>>>);
+    static_assert(ops_of<Folded> == 1);
+
+    // polynomial in Horner form: three fused multiply-adds instead of 3 mul + 3 add,
+    // with array or scalar coefficients
+    using Horner = decltype(((a3*x + a2)*x + a1)*x + a0);
+    static_assert(ops_of<Horner> == 3);
+    using HornerScalar = decltype(((-0.125*x + 0.25)*x + -0.5)*x + 1.0);
+    static_assert(ops_of<HornerScalar> == 3);
+
+    // 1.2*x + x*y: one multiplication and one fused multiply-add
+    using Axpy = decltype(1.2*x + x*y);
+    static_assert(std::is_same_v<Axpy, Array<double,
+        A_FMA<double, A_Scalar<double>, SArray<double>,
+              A_Mult<double, SArray<double>, SArray<double>>>>>);
+    static_assert(ops_of<Axpy> == 2);
+
+    // repeated subexpression: x*y + x*y computes x*y once, while x*y + y*x, whose operands
+    // have the same type but are different subexpressions, computes both products
+    int const reps = 2000;
+    auto const shared = time_ns([&]{
+        for (int i = 0; i < reps; ++i) {
+            r = x*y + x*y;
+            do_not_optimize(r[0]);
+        }
+    });
+    auto const distinct = time_ns([&]{
+        for (int i = 0; i < reps; ++i) {
+            r = x*y + y*x;
+            do_not_optimize(r[0]);
+        }
+    });
+    auto const per_elem = [&](double ns){ return ns / static_cast<double>(n * reps); };
+    std::cout << "x*y + x*y (shared):   " << per_elem(shared) << " ns/elem, "
+              << evaluated_ops(x*y + x*y) << " ops/elem\n"
+              << "x*y + y*x (distinct): " << per_elem(distinct) << " ns/elem, "
+              << evaluated_ops(x*y + y*x) << " ops/elem\n";
+
+    r = ((a3*x + a2)*x + a1)*x + a0;
+    std::cout << "p(x[0]) = " << r[0] << '\n';
+}
@@ -13,4 +13,6 @@ int main()
     // tmp2 = x*y       -- loop of 1000 operations, plus ctor/dtor of tmp2
     // tmp3 = tmp1+tmp2 -- loop of 1000 operations, plux ctor/dtor of tmp3
     // x = tmp3;        -- 1000 read operations and 1000 write operations
+    //                     (or, now that SArray has a move assignment, a pointer swap -
+    //                      the temporaries remain though)
 }
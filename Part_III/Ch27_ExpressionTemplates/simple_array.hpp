@@ -2,40 +2,102 @@
 
 #include <cstddef>
 #include <cassert>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "aligned_allocator.hpp"
+#include "expr_packet.hpp"
+#include "expr_counters.hpp"
 
 
-template<typename T>
+// tag to request an array whose elements are default- rather than value-initialized,
+// i.e. left uninitialized for trivial types - for arrays which are first written by
+// an expression anyway
+struct uninitialized_t { explicit uninitialized_t() = default; };
+constexpr inline uninitialized_t uninitialized{};
+
+
+template<typename T, typename Allocator = AlignedAllocator<T>>
 class SArray
 {
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
 public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    // elements are contiguous, so they can be loaded and stored a packet at a time
+    static constexpr bool packet_access = true;
+
     // create array with initial size
-    explicit SArray(std::size_t s)
-        : storage_{new T[s]}, storage_size_{s}
+    explicit SArray(std::size_t s, Allocator const& alloc = Allocator{})
+        : alloc_{alloc}, storage_{allocate(s)}, storage_size_{s}
         {
             init();
         }
-    
+
+    // create array with initial size without initializing the elements
+    SArray(std::size_t s, uninitialized_t, Allocator const& alloc = Allocator{})
+        : alloc_{alloc}, storage_{allocate(s)}, storage_size_{s}
+        {
+            std::uninitialized_default_construct_n(storage_, s);
+        }
+
     // copy constructor
     SArray(SArray const& orig)
-        : storage_{new T[orig.size()]}, storage_size_{orig.size()}
+        : alloc_{alloc_traits::select_on_container_copy_construction(orig.alloc_)},
+          storage_{allocate(orig.size())}, storage_size_{orig.size()}
         {
-            copy(orig);
+            EXPR_COUNT_COPY(SArray, size() * sizeof(T));
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                copy(orig);
+            }
+            else {
+                std::uninitialized_copy_n(orig.storage_, size(), storage_);
+            }
         }
 
+    // move constructor - takes over the storage of orig, which is left empty
+    SArray(SArray&& orig) noexcept
+        : alloc_{std::move(orig.alloc_)},
+          storage_{std::exchange(orig.storage_, nullptr)},
+          storage_size_{std::exchange(orig.storage_size_, 0)}
+        { }
+
     // destructor
     ~SArray() {
-        delete[] storage_;
+        release();
     }
 
     // assignement
     SArray& operator=(SArray const& orig)
     {
         if (&orig != this) {
+            EXPR_COUNT_COPY(SArray, size() * sizeof(T));
             copy(orig);
         }
         return *this;
     }
 
+    // move assignment - unlike copy assignment the sizes need not match,
+    // the array simply takes over the storage of orig
+    SArray& operator=(SArray&& orig) noexcept
+    {
+        static_assert(alloc_traits::is_always_equal::value
+                      || alloc_traits::propagate_on_container_move_assignment::value,
+                      "SArray: move assignment requires interchangeable allocators");
+        if (&orig != this) {
+            release();
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(orig.alloc_);
+            }
+            storage_ = std::exchange(orig.storage_, nullptr);
+            storage_size_ = std::exchange(orig.storage_size_, 0);
+        }
+        return *this;
+    }
+
     // return size
     std::size_t size() const {
         return storage_size_;
@@ -50,23 +112,60 @@ public:
         return storage_[idx];
     }
 
+    // packet access to elements [idx, idx + Packet<T>::size)
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Packet<T>::load(storage_ + idx);
+    }
+
+    void store_packet(std::size_t idx, typename Packet<T>::type v) {
+        Packet<T>::store(storage_ + idx, v);
+    }
+
+    // raw access to the elements
+    T const* data() const { return storage_; }
+    T* data() { return storage_; }
+
+    allocator_type get_allocator() const { return alloc_; }
+
 protected:
     // init values with default constructor
+    // (for trivial types this is a single memset rather than an element-wise loop)
     void init() {
-        for (std::size_t idx = 0; idx < size(); ++idx) {
-            storage_[idx] = T{};
-        }
+        std::uninitialized_value_construct_n(storage_, size());
     }
     // copy values of another array
     void copy(SArray const& orig) {
         assert(size() == orig.size());
-        for (std::size_t idx = 0; idx < size(); ++idx) {
-            storage_[idx] = orig.storage_[idx];
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (size() != 0) {
+                std::memcpy(storage_, orig.storage_, size() * sizeof(T));
+            }
+        }
+        else {
+            for (std::size_t idx = 0; idx < size(); ++idx) {
+                storage_[idx] = orig.storage_[idx];
+            }
         }
     }
 
 private:
+    T* allocate(std::size_t s) {
+        if (s == 0) {
+            return nullptr;
+        }
+        EXPR_COUNT_ALLOCATION(SArray, s * sizeof(T));
+        return alloc_traits::allocate(alloc_, s);
+    }
+
+    // destroy the elements and give the storage back to the allocator
+    void release() {
+        if (storage_ != nullptr) {
+            std::destroy_n(storage_, storage_size_);
+            alloc_traits::deallocate(alloc_, storage_, storage_size_);
+        }
+    }
+
+    Allocator   alloc_;             // allocator of the storage
     T*          storage_;           // storage of the elements
     std::size_t storage_size_;      // number of elements
 };
-
@@ -2,13 +2,15 @@
 
 #include "simple_array.hpp"
 
+// The result arrays are created uninitialized, since every element is written by the loop,
+// and are returned by move rather than by deep copy.
 
 // addition of two arrays
-template<typename T>
-SArray<T> operator+ (SArray<T> const& a, SArray<T> const& b)
+template<typename T, typename A>
+SArray<T,A> operator+ (SArray<T,A> const& a, SArray<T,A> const& b)
 {
     assert(a.size() == b.size());
-    SArray<T> result(a.size());
+    SArray<T,A> result(a.size(), uninitialized);
     for (std::size_t k = 0; k < a.size(); ++k) {
         result[k] = a[k] + b[k];
     }
@@ -16,11 +18,11 @@ SArray<T> operator+ (SArray<T> const& a, SArray<T> const& b)
 }
 
 // multiplication of two arrays
-template<typename T>
-SArray<T> operator* (SArray<T> const& a, SArray<T> const& b)
+template<typename T, typename A>
+SArray<T,A> operator* (SArray<T,A> const& a, SArray<T,A> const& b)
 {
     assert(a.size() == b.size());
-    SArray<T> result{a.size()};
+    SArray<T,A> result{a.size(), uninitialized};
     for (std::size_t k = 0; k < a.size(); ++k) {
         result[k] = a[k] * b[k];
     }
@@ -28,12 +30,30 @@ SArray<T> operator* (SArray<T> const& a, SArray<T> const& b)
 }
 
 // multiplication of scalar and SArray
-template<typename T>
-SArray<T> operator* (T const& s, SArray<T> const& a)
+template<typename T, typename A>
+SArray<T,A> operator* (T const& s, SArray<T,A> const& a)
 {
-    SArray<T> result{a.size()};
+    SArray<T,A> result{a.size(), uninitialized};
     for (std::size_t k = 0; k < a.size(); ++k) {
         result[k] = s * a[k];
     }
     return result;
 }
+
+// addition of SArray and scalar
+template<typename T, typename A>
+SArray<T,A> operator+ (SArray<T,A> const& a, T const& s)
+{
+    SArray<T,A> result{a.size(), uninitialized};
+    for (std::size_t k = 0; k < a.size(); ++k) {
+        result[k] = a[k] + s;
+    }
+    return result;
+}
+
+// addition of scalar and SArray
+template<typename T, typename A>
+SArray<T,A> operator+ (T const& s, SArray<T,A> const& a)
+{
+    return a + s;
+}
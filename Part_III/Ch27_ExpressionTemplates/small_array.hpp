@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "aligned_allocator.hpp"
+#include "simple_array.hpp"
+#include "expr_packet.hpp"
+
+
+// SArray with a small buffer: arrays of up to InlineN elements keep them inside the object,
+// only larger ones allocate. For code which creates many short arrays whose size is only
+// known at run time (with a compile-time size FixedArray is the better choice).
+// The interface and semantics are those of SArray, except that moving an array with
+// inline elements moves the elements one by one.
+template<typename T, std::size_t InlineN = (64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1),
+         typename Allocator = AlignedAllocator<T>>
+class SmallArray
+{
+    static_assert(InlineN > 0, "SmallArray: the inline buffer must hold at least one element");
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    static constexpr bool packet_access = true;
+    static constexpr std::size_t inline_capacity = InlineN;
+
+    // create array with initial size
+    explicit SmallArray(std::size_t s, Allocator const& alloc = Allocator{})
+        : alloc_{alloc}, storage_{acquire(s)}, storage_size_{s}
+        {
+            std::uninitialized_value_construct_n(storage_, s);
+        }
+
+    // create array with initial size without initializing the elements
+    SmallArray(std::size_t s, uninitialized_t, Allocator const& alloc = Allocator{})
+        : alloc_{alloc}, storage_{acquire(s)}, storage_size_{s}
+        {
+            std::uninitialized_default_construct_n(storage_, s);
+        }
+
+    SmallArray(SmallArray const& orig)
+        : alloc_{alloc_traits::select_on_container_copy_construction(orig.alloc_)},
+          storage_{acquire(orig.size())}, storage_size_{orig.size()}
+        {
+            std::uninitialized_copy_n(orig.storage_, size(), storage_);
+        }
+
+    // move constructor - takes over the storage of a heap allocated orig,
+    // moves the elements of an inline one; orig is left empty
+    SmallArray(SmallArray&& orig) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : alloc_{std::move(orig.alloc_)}, storage_{inline_data()}, storage_size_{0}
+        {
+            take(orig);
+        }
+
+    ~SmallArray() {
+        release();
+    }
+
+    SmallArray& operator=(SmallArray const& orig)
+    {
+        assert(size() == orig.size());
+        if (&orig != this) {
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                if (size() != 0) {
+                    std::memcpy(storage_, orig.storage_, size() * sizeof(T));
+                }
+            }
+            else {
+                std::copy_n(orig.storage_, size(), storage_);
+            }
+        }
+        return *this;
+    }
+
+    // like SArray the sizes need not match
+    SmallArray& operator=(SmallArray&& orig) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        static_assert(alloc_traits::is_always_equal::value
+                      || alloc_traits::propagate_on_container_move_assignment::value,
+                      "SmallArray: move assignment requires interchangeable allocators");
+        if (&orig != this) {
+            release();
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(orig.alloc_);
+            }
+            take(orig);
+        }
+        return *this;
+    }
+
+    std::size_t size() const {
+        return storage_size_;
+    }
+
+    // are the elements stored inside the object
+    bool is_inline() const {
+        return storage_size_ <= InlineN;
+    }
+
+    T const& operator[](std::size_t idx) const {
+        return storage_[idx];
+    }
+
+    T& operator[](std::size_t idx) {
+        return storage_[idx];
+    }
+
+    typename Packet<T>::type load_packet(std::size_t idx) const {
+        return Packet<T>::load(storage_ + idx);
+    }
+
+    void store_packet(std::size_t idx, typename Packet<T>::type v) {
+        Packet<T>::store(storage_ + idx, v);
+    }
+
+    T const* data() const { return storage_; }
+    T* data() { return storage_; }
+
+    allocator_type get_allocator() const { return alloc_; }
+
+private:
+    T* inline_data() {
+        return reinterpret_cast<T*>(buffer_);
+    }
+
+    // storage for s elements
+    T* acquire(std::size_t s) {
+        return s <= InlineN ? inline_data() : alloc_traits::allocate(alloc_, s);
+    }
+
+    // destroy the elements and give heap storage back to the allocator,
+    // leaving an empty array
+    void release() {
+        std::destroy_n(storage_, storage_size_);
+        if (!is_inline()) {
+            alloc_traits::deallocate(alloc_, storage_, storage_size_);
+        }
+        storage_ = inline_data();
+        storage_size_ = 0;
+    }
+
+    // take over the elements of orig (this array is empty), leaving orig empty
+    void take(SmallArray& orig) {
+        if (orig.is_inline()) {
+            std::uninitialized_move_n(orig.storage_, orig.size(), storage_);
+            storage_size_ = orig.size();
+            orig.release();
+        }
+        else {
+            storage_ = std::exchange(orig.storage_, orig.inline_data());
+            storage_size_ = std::exchange(orig.storage_size_, 0);
+        }
+    }
+
+    Allocator   alloc_;                 // allocator of heap storage
+    T*          storage_;               // the inline buffer or heap storage
+    std::size_t storage_size_;          // number of elements
+    alignas(T) unsigned char buffer_[InlineN * sizeof(T)];  // inline elements
+};
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "expr_sparse.hpp"
+
+// Array representations which store only the nonzero elements (see expr_sparse.hpp):
+// - SparseArray - sorted index / value pairs, for arrays that are mostly zeros
+// - RleArray    - runs of equal elements, for piecewise constant arrays
+//   Array<double, SparseArray<double>> a{SparseArray<double>{n, indices, values}};
+//   Array<double, RleArray<double>> r{RleArray<double>{n}};
+//   r = where(x > 0.0, 1.0, 0.0);     // compressed while assigned
+//   z = 2.0*a*y + r;                  // the support of a*y is that of a
+// Reading a single element is a binary search; expressions read them in order instead.
+
+
+// class for arrays of n elements of which only the nonzero ones are stored
+template<typename T>
+class SparseArray
+{
+public:
+    using value_type = T;
+    static constexpr bool sparse = true;
+
+    // n zeros
+    explicit SparseArray(std::size_t n)
+        : size_{n}, indices_{}, values_{} { }
+
+    // n elements, zero but at the given (increasing) indices
+    SparseArray(std::size_t n, std::vector<std::size_t> indices, std::vector<T> values)
+        : size_{n}, indices_{std::move(indices)}, values_{std::move(values)}
+        {
+            assert(indices_.size() == values_.size());
+            assert(std::is_sorted(indices_.begin(), indices_.end()));
+            assert(std::adjacent_find(indices_.begin(), indices_.end()) == indices_.end());
+            assert(indices_.empty() || indices_.back() < size_);
+        }
+
+    std::size_t size() const { return size_; }
+
+    // number of stored elements
+    std::size_t nonzeros() const { return indices_.size(); }
+
+    T operator[](std::size_t idx) const {
+        auto const it = std::lower_bound(indices_.begin(), indices_.end(), idx);
+        return it != indices_.end() && *it == idx
+               ? values_[static_cast<std::size_t>(it - indices_.begin())] : T{};
+    }
+
+    std::vector<std::size_t> const& indices() const { return indices_; }
+    std::vector<T> const& values() const { return values_; }
+
+    // elements [first, last) have the value - after the elements appended so far
+    void append(std::size_t first, std::size_t last, T const& value) {
+        assert(indices_.empty() || indices_.back() < first);
+        assert(last <= size_);
+        if (value != T{}) {
+            for (std::size_t idx = first; idx < last; ++idx) {
+                indices_.push_back(idx);
+                values_.push_back(value);
+            }
+        }
+    }
+
+private:
+    std::size_t size_;
+    std::vector<std::size_t> indices_;  // increasing
+    std::vector<T> values_;
+};
+
+
+// class for arrays of n elements stored as runs of equal elements
+template<typename T>
+class RleArray
+{
+public:
+    using value_type = T;
+    static constexpr bool sparse = true;
+
+    // n zeros
+    explicit RleArray(std::size_t n)
+        : size_{n}, ends_{}, values_{} { }
+
+    std::size_t size() const { return size_; }
+
+    // number of runs
+    std::size_t runs() const { return ends_.size(); }
+
+    T operator[](std::size_t idx) const {
+        auto const it = std::upper_bound(ends_.begin(), ends_.end(), idx);
+        return it != ends_.end() ? values_[static_cast<std::size_t>(it - ends_.begin())] : T{};
+    }
+
+    // run r covers [ends()[r-1], ends()[r]) (from 0 for the first); elements after the last
+    // run are zero
+    std::vector<std::size_t> const& ends() const { return ends_; }
+    std::vector<T> const& values() const { return values_; }
+
+    // elements [first, last) have the value - after the elements appended so far
+    void append(std::size_t first, std::size_t last, T const& value) {
+        std::size_t const end = ends_.empty() ? 0 : ends_.back();
+        assert(end <= first && first <= last && last <= size_);
+        if (end < first) {
+            extend(first, T{});
+        }
+        extend(last, value);
+    }
+
+private:
+    // continue the last run, or start a new one, up to last
+    void extend(std::size_t last, T const& value) {
+        if (!values_.empty() && values_.back() == value) {
+            ends_.back() = last;
+        }
+        else {
+            ends_.push_back(last);
+            values_.push_back(value);
+        }
+    }
+
+    std::size_t size_;
+    std::vector<std::size_t> ends_;     // increasing
+    std::vector<T> values_;
+};
+
+
+// the cursor of a SparseArray - its support are the stored elements
+template<typename T>
+class SparseArrayCursor
+{
+public:
+    using value_type = T;
+    static constexpr bool sparse = true;
+
+    SparseArrayCursor(SparseArray<T> const& a, std::size_t n)
+        : indices_{a.indices().data()}, values_{a.values().data()}, nonzeros_{a.nonzeros()},
+          n_{n}, pos_{0}, next_{0}
+        { }
+
+    // consecutive indices form one range
+    bool next(IndexRange& r) {
+        if (next_ == nonzeros_) {
+            return false;
+        }
+        r = IndexRange{indices_[next_], indices_[next_] + 1};
+        for (++next_; next_ < nonzeros_ && indices_[next_] == r.last; ++next_) {
+            ++r.last;
+        }
+        return true;
+    }
+
+    T at(std::size_t idx) {
+        while (pos_ < nonzeros_ && indices_[pos_] < idx) {
+            ++pos_;
+        }
+        return pos_ < nonzeros_ && indices_[pos_] == idx ? values_[pos_] : T{};
+    }
+
+    // a stored element is a run by itself, a zero lasts up to the next stored element
+    std::size_t run_end(std::size_t idx) const {
+        if (pos_ == nonzeros_) {
+            return n_;
+        }
+        return indices_[pos_] == idx ? idx + 1 : indices_[pos_];
+    }
+
+private:
+    std::size_t const* indices_;
+    T const* values_;
+    std::size_t nonzeros_;
+    std::size_t n_;
+    std::size_t pos_;   // the element at(), and run_end(), are at
+    std::size_t next_;  // the element next() continues from
+};
+
+// the cursor of an RleArray - its support are the runs of nonzero elements
+template<typename T>
+class RleArrayCursor
+{
+public:
+    using value_type = T;
+    static constexpr bool sparse = true;
+
+    RleArrayCursor(RleArray<T> const& a, std::size_t n)
+        : ends_{a.ends().data()}, values_{a.values().data()}, runs_{a.runs()},
+          n_{n}, pos_{0}, next_{0}
+        { }
+
+    // consecutive nonzero runs form one range
+    bool next(IndexRange& r) {
+        while (next_ < runs_ && values_[next_] == T{}) {
+            ++next_;
+        }
+        if (next_ == runs_) {
+            return false;
+        }
+        r = IndexRange{next_ == 0 ? 0 : ends_[next_ - 1], ends_[next_]};
+        for (++next_; next_ < runs_ && values_[next_] != T{}; ++next_) {
+            r.last = ends_[next_];
+        }
+        return true;
+    }
+
+    T at(std::size_t idx) {
+        while (pos_ < runs_ && ends_[pos_] <= idx) {
+            ++pos_;
+        }
+        return pos_ < runs_ ? values_[pos_] : T{};
+    }
+
+    std::size_t run_end(std::size_t) const {
+        return pos_ < runs_ ? ends_[pos_] : n_;
+    }
+
+private:
+    std::size_t const* ends_;
+    T const* values_;
+    std::size_t runs_;
+    std::size_t n_;
+    std::size_t pos_;
+    std::size_t next_;
+};
+
+template<typename T>
+SparseArrayCursor<T> sparse_cursor(SparseArray<T> const& a, std::size_t n)
+{
+    return SparseArrayCursor<T>{a, n};
+}
+
+template<typename T>
+RleArrayCursor<T> sparse_cursor(RleArray<T> const& a, std::size_t n)
+{
+    return RleArrayCursor<T>{a, n};
+}
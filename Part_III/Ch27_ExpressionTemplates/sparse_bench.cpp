@@ -0,0 +1,107 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "sparse_array.hpp"
+#include "bench_util.hpp"
+
+
+// z = a*x + b with a, b mostly zeros and x dense, for decreasing density:
+// - dense:  a, b and z stored densely - the packet loop over all elements
+// - sparse: a, b and z SparseArrays - the support of a*x is that of a, merged with that of b
+// and 2.0*r + r*r for a piecewise constant r, densely and as runs (RleArray).
+// (the cursors visit one element at a time, so at high densities the packet loop
+// over all elements wins)
+// The dense times stay the same, the sparse ones follow the number of nonzeros (runs).
+//
+// usage: sparse_bench [elements]
+
+using Sparse = Array<double, SparseArray<double>>;
+using Rle = Array<double, RleArray<double>>;
+
+static_assert(has_sparse_support_v<A_Mult<double, SparseArray<double>, SArray<double>>>);
+static_assert(has_sparse_support_v<A_FMA<double, SparseArray<double>, SArray<double>,
+                                         SparseArray<double>>>);
+// (a dense operand of a sum makes the sum dense)
+static_assert(!has_sparse_support_v<A_Add<double, SparseArray<double>, SArray<double>>>);
+
+SparseArray<double> random_sparse(std::size_t n, double density, std::mt19937& rng)
+{
+    std::uniform_real_distribution<double> u{0.0, 1.0};
+    std::vector<std::size_t> indices;
+    std::vector<double> values;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (u(rng) < density) {
+            indices.push_back(i);
+            values.push_back(u(rng) + 0.5);
+        }
+    }
+    return SparseArray<double>{n, std::move(indices), std::move(values)};
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t const n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4'000'000;
+    std::cout << "elements: " << n << '\n';
+    std::mt19937 rng{42};
+
+    Array<double> x{n, uninitialized}, da{n, uninitialized}, db{n, uninitialized},
+                  dz{n, uninitialized};
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = std::sin(static_cast<double>(i));
+    }
+
+    std::cout << "z = a*x + b      dense ms   sparse ms   nonzeros   sparse ns/nonzero\n";
+    for (double const density : {0.5, 0.1, 0.01, 0.001}) {
+        Sparse a{random_sparse(n, density, rng)}, b{random_sparse(n, density, rng)},
+               z{SparseArray<double>{n}};
+        da = a;
+        db = b;
+        auto const dense = time_ns([&]{
+            dz = da*x + db;
+            do_not_optimize(dz[0]);
+        });
+        auto const sparse = time_ns([&]{
+            z = a*x + b;
+            do_not_optimize(z.rep().nonzeros());
+        });
+        bool same = true;
+        for (std::size_t i = 0; i < n; i += 997) {
+            same = same && std::abs(z[i] - dz[i]) <= 1e-12;
+        }
+        std::size_t const nonzeros = z.rep().nonzeros();
+        std::cout << "density " << std::setw(6) << density << std::setw(11) << dense / 1e6
+                  << std::setw(12) << sparse / 1e6 << std::setw(11) << nonzeros
+                  << std::setw(14) << sparse / static_cast<double>(std::max<std::size_t>(nonzeros, 1))
+                  << (same ? "" : "  (wrong result)") << '\n';
+    }
+
+    std::cout << "z = 2*r + r*r    dense ms   runs ms     runs\n";
+    for (std::size_t const run_length : {std::size_t{10}, std::size_t{1000}, std::size_t{100000}}) {
+        Array<double> dr{n, uninitialized};
+        for (std::size_t i = 0; i < n; ++i) {
+            dr[i] = static_cast<double>(i / run_length % 4);
+        }
+        Rle r{RleArray<double>{n}}, z{RleArray<double>{n}};
+        r = dr;
+        auto const dense = time_ns([&]{
+            dz = 2.0*dr + dr*dr;
+            do_not_optimize(dz[0]);
+        });
+        auto const runs = time_ns([&]{
+            z = 2.0*r + r*r;
+            do_not_optimize(z.rep().runs());
+        });
+        bool same = true;
+        for (std::size_t i = 0; i < n; i += 997) {
+            same = same && std::abs(z[i] - dz[i]) <= 1e-12;
+        }
+        std::cout << "run length " << std::setw(6) << run_length << std::setw(10) << dense / 1e6
+                  << std::setw(10) << runs / 1e6 << std::setw(9) << z.rep().runs()
+                  << (same ? "" : "  (wrong result)") << '\n';
+    }
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+#include "expr_array.hpp"
+#include "expr_ops.hpp"
+#include "expr_capture.hpp"
+#include "expr_stencil.hpp"
+#include "bench_util.hpp"
+
+
+// An N-tap FIR filter y[i] = h[0]*x[i] + h[1]*x[i-1] + ... + h[N-1]*x[i-N+1], with x zero
+// before its first element, for N = 3, 5 and 9:
+// - hand-written - the interior loop, the first N-1 elements separately
+// - stencil(x, {h[N-1], ..., h[0]}, boundary_zero, -(N-1)) - one node
+// - h[0]*x + h[1]*shift(x, -1) + ... - a sum of shifted views
+// Both expressions are evaluated in one loop, loading the shifted packets of x.
+//
+// usage: stencil_bench [elements]
+
+template<std::size_t N>
+void fir(double* y, double const* x, std::size_t n, double const (&h)[N])
+{
+    std::size_t const edge = std::min(n, N - 1);
+    for (std::size_t i = 0; i < edge; ++i) {
+        double sum = 0.0;
+        for (std::size_t k = 0; k <= i; ++k) {
+            sum += h[k] * x[i - k];
+        }
+        y[i] = sum;
+    }
+    for (std::size_t i = edge; i < n; ++i) {
+        double sum = h[0] * x[i];
+        for (std::size_t k = 1; k < N; ++k) {
+            sum += h[k] * x[i - k];
+        }
+        y[i] = sum;
+    }
+}
+
+// (captured - the nodes of the sum are temporaries of this function)
+template<std::size_t N, std::size_t... K>
+auto shifted_sum(Array<double> const& x, double const (&h)[N], std::index_sequence<K...>)
+{
+    return capture((... + (h[K] * shift(x, -static_cast<std::ptrdiff_t>(K)))));
+}
+
+template<std::size_t N>
+void run(Array<double> const& x, Array<double>& y, double const (&h)[N])
+{
+    std::size_t const n = x.size();
+    double reversed[N];
+    for (std::size_t k = 0; k < N; ++k) {
+        reversed[k] = h[N - 1 - k];
+    }
+    Array<double> expected{n, uninitialized};
+
+    auto const hand = time_ns([&]{
+        fir(expected.rep().data(), x.rep().data(), n, h);
+        do_not_optimize(expected[0]);
+    });
+    auto const node = time_ns([&]{
+        y = stencil(x, reversed, boundary_zero, -static_cast<std::ptrdiff_t>(N - 1));
+        do_not_optimize(y[0]);
+    });
+    bool same = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        same = same && std::abs(y[i] - expected[i]) <= 1e-12;
+    }
+    auto const shifts = time_ns([&]{
+        y = shifted_sum(x, h, std::make_index_sequence<N>{});
+        do_not_optimize(y[0]);
+    });
+    for (std::size_t i = 0; i < n; ++i) {
+        same = same && std::abs(y[i] - expected[i]) <= 1e-12;
+    }
+
+    auto const per_elem = [n](double ns) { return ns / static_cast<double>(n); };
+    std::cout << std::setw(2) << N << "-tap" << std::setw(14) << per_elem(hand)
+              << std::setw(13) << per_elem(node) << std::setw(13) << per_elem(shifts)
+              << (same ? "" : "  (wrong result)") << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t const n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    std::cout << "elements: " << n << '\n';
+
+    Array<double> x{n, uninitialized}, y{n, uninitialized};
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = std::sin(0.01 * static_cast<double>(i));
+    }
+
+    double const h3[] = {0.25, 0.5, 0.25};
+    double const h5[] = {0.1, 0.2, 0.4, 0.2, 0.1};
+    double const h9[] = {0.02, 0.05, 0.1, 0.15, 0.36, 0.15, 0.1, 0.05, 0.02};
+
+    std::cout << "ns/elem    hand-written    stencil()    shifts\n";
+    run(x, y, h3);
+    run(x, y, h5);
+    run(x, y, h9);
+}